@@ -41,35 +41,35 @@ void ICalBody::readContentLine( const QString inContent )
             {
                 m_activeComponent = IN_VEVENT;
                 VEventComponent component = VEventComponent();
-                m_vEventComponents.append( component );
+                m_vEventComponents.append( std::move( component ) );
                 return;
             }
             if( m_currentComponentName.compare( "VFREEBUSY" ) == 0 )
             {
                 m_activeComponent = IN_VFREEBUSY;
                 VFreeBusyComponent component = VFreeBusyComponent();
-                m_vFreeBusyComponents.append( component );
+                m_vFreeBusyComponents.append( std::move( component ) );
                 return;
             }
             if( m_currentComponentName.compare( "VJOURNAL" ) == 0 )
             {
                 m_activeComponent = IN_VJOURNAL;
                 VJournalComponent component = VJournalComponent();
-                m_vJournalComponents.append( component );
+                m_vJournalComponents.append( std::move( component ) );
                 return;
             }
             if( m_currentComponentName.compare( "VTODO" ) == 0 )
             {
                 m_activeComponent = IN_VTODO;
                 VTodoComponent component = VTodoComponent();
-                m_vToDoComponents.append( component );
+                m_vToDoComponents.append( std::move( component ) );
                 return;
             }
             if( m_currentComponentName.compare( "VTIMEZONE" ) == 0 )
             {
                 m_activeComponent = IN_VTIMEZONE;
                 VTimezoneComponent component = VTimezoneComponent();
-                m_vTimezoneComponents.append( component );
+                m_vTimezoneComponents.append( std::move( component ) );
                 return;
             }
 
@@ -111,7 +111,7 @@ void ICalBody::readContentLine( const QString inContent )
         {
             Property prop = Property();
             prop.readProperty( inContent );
-            m_properties.append( prop );
+            m_properties.append( std::move( prop ) );
         }
         break;
         case IN_OTHER:
@@ -140,17 +140,17 @@ void ICalBody::readContentLine( const QString inContent )
 QString ICalBody::getContent() const
 {
     QString s( "ICalBody: " );
-    for( const Property p : m_properties )
+    for( const Property &p : m_properties )
         s = s.append( p.contentToString() );
-    for( const VEventComponent vec : m_vEventComponents )
+    for( const VEventComponent &vec : m_vEventComponents )
         s = s.append( vec.contentToString() );
-    for( const VFreeBusyComponent vfbc : m_vFreeBusyComponents )
+    for( const VFreeBusyComponent &vfbc : m_vFreeBusyComponents )
         s = s.append( vfbc.contentToString() );
-    for( const VJournalComponent vjc : m_vJournalComponents )
+    for( const VJournalComponent &vjc : m_vJournalComponents )
         s = s.append( vjc.contentToString() );
-    for( const VTodoComponent vtc : m_vToDoComponents )
+    for( const VTodoComponent &vtc : m_vToDoComponents )
         s = s.append( vtc.contentToString() );
-    for( const VTimezoneComponent vtzc : m_vTimezoneComponents )
+    for( const VTimezoneComponent &vtzc : m_vTimezoneComponents )
         s = s.append( vtzc.contentToString() );
     return s;
 }
@@ -160,15 +160,15 @@ bool ICalBody::validateIcal()
 {
     qDebug() << "BEGIN VALIDATE";
     bool ret = validateIcalBody();
-    for( VEventComponent vec : m_vEventComponents )
+    for( VEventComponent &vec : m_vEventComponents )
         ret = ret and vec.validate();
-    for( VFreeBusyComponent vfbc : m_vFreeBusyComponents )
+    for( VFreeBusyComponent &vfbc : m_vFreeBusyComponents )
         ret = ret and vfbc.validate();
-    for( VJournalComponent vjc : m_vJournalComponents )
+    for( VJournalComponent &vjc : m_vJournalComponents )
         ret = ret and vjc.validate();
-    for( VTimezoneComponent vtzc : m_vTimezoneComponents )
+    for( VTimezoneComponent &vtzc : m_vTimezoneComponents )
         ret = ret and vtzc.validate();
-    for( VTodoComponent vtc : m_vToDoComponents )
+    for( VTodoComponent &vtc : m_vToDoComponents )
         ret = ret and vtc.validate();
     qDebug() << "END VALIDATE";
     return ret;
@@ -182,7 +182,7 @@ bool ICalBody::validateIcalBody()
     bool prod_id_modified = false;  // just a warning
     int count_required_prod_id = 0; // MUST: 1
     bool prop_ok = true;
-    for( const Property prop : m_properties )
+    for( const Property &prop : m_properties )
     {
         if( prop.m_hasErrors )
         {
@@ -214,7 +214,7 @@ bool ICalBody::validateIcalBody()
     {
         Property p = Property();
         p.readProperty( "PRODID:-//DAYLIGHT//Modified//EN" );
-        m_properties.append( p );
+        m_properties.append( std::move( p ) );
         count_required_prod_id++;
     }
 
@@ -24,9 +24,9 @@
 #include "vtimezonecomponent.h"
 #include "vtodocomponent.h"
 
-#include <QList>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 
 
 struct ICalBody
@@ -54,14 +54,15 @@ struct ICalBody
     bool validateIcal();
     bool validateIcalBody();
 
-    QList<Property>             m_properties;
+    // QVector keeps the components in one block each, QList would allocate every element
+    QVector<Property>           m_properties;
     ReadComponent               m_activeComponent;
     QString                     m_currentComponentName;
-    QList<VEventComponent>      m_vEventComponents;
-    QList<VFreeBusyComponent>   m_vFreeBusyComponents;
-    QList<VJournalComponent>    m_vJournalComponents;
-    QList<VTodoComponent>       m_vToDoComponents;
-    QList<VTimezoneComponent>   m_vTimezoneComponents;
+    QVector<VEventComponent>    m_vEventComponents;
+    QVector<VFreeBusyComponent> m_vFreeBusyComponents;
+    QVector<VJournalComponent>  m_vJournalComponents;
+    QVector<VTodoComponent>     m_vToDoComponents;
+    QVector<VTimezoneComponent> m_vTimezoneComponents;
 };
 
 #endif // ICALBODY_H
@@ -19,6 +19,7 @@
 #include "parameter.h"
 
 #include <QDebug>
+#include <QThread>
 
 
 IcalInterpreter::IcalInterpreter( QObject *parent )
@@ -30,12 +31,18 @@ IcalInterpreter::IcalInterpreter( QObject *parent )
 
 void IcalInterpreter::readIcal( const ICalBody &inIcal )
 {
+    for( const VFreeBusyComponent &component : inIcal.m_vFreeBusyComponents )
+        readFreeBusy( component );
+
     if( not inIcal.m_vEventComponents.isEmpty() )
     {
         int count = inIcal.m_vEventComponents.count();
         int num = 1;
-        for( const VEventComponent component : inIcal.m_vEventComponents )
+        for( const VEventComponent &component : inIcal.m_vEventComponents )
         {
+            // the import was cancelled
+            if( QThread::currentThread()->isInterruptionRequested() )
+                return;
             AppointmentBasics *basic = nullptr;
             QVector<AppointmentAlarm*> alarmList;
             AppointmentRecurrence *recurrence = nullptr;
@@ -50,7 +57,56 @@ void IcalInterpreter::readIcal( const ICalBody &inIcal )
 }
 
 
-void IcalInterpreter::readEvent(const VEventComponent inVEventComponent,
+const QVector<FreeBusyPeriod> &IcalInterpreter::freeBusyPeriods() const
+{
+    return m_freeBusyPeriods;
+}
+
+
+void IcalInterpreter::readFreeBusy( const VFreeBusyComponent &inVFreeBusyComponent )
+{
+    for( const Property &p : inVFreeBusyComponent.m_properties )
+    {
+        if( p.m_type != Property::PT_FREEBUSY )
+            continue;
+        // BUSY is the default, BUSY-TENTATIVE and BUSY-UNAVAILABLE block the time as well
+        Parameter fbType;
+        if( p.getParameterByType( Parameter::FBTYPEPARAM, fbType ) and fbType.m_content == "FREE" )
+            continue;
+        const QStringList periods = p.m_storageType == Property::PST_STRINGLIST ?
+                    p.m_contentStringList : QStringList( p.m_content );
+        for( const QString &period : periods )
+        {
+            // Example: 19970308T160000Z/PT8H30M or 19970308T160000Z/19970308T163000Z
+            const QStringList bounds = period.split( '/', QString::SkipEmptyParts );
+            DateTime start;
+            if( bounds.count() != 2 or not start.readDateTime( bounds.first() ) or start.isDate() )
+                continue;
+            const qint64 startSecs = start.toSecsSinceEpoch();
+            qint64 endSecs;
+            if( bounds.last().contains( 'P', Qt::CaseInsensitive ) )
+            {
+                Duration duration;
+                duration.setZero();
+                if( not duration.readDuration( bounds.last().toUpper() ) )
+                    continue;
+                endSecs = startSecs + duration.toSeconds();
+            }
+            else
+            {
+                DateTime end;
+                if( not end.readDateTime( bounds.last() ) or end.isDate() )
+                    continue;
+                endSecs = end.toSecsSinceEpoch();
+            }
+            if( endSecs > startSecs )
+                m_freeBusyPeriods.append( FreeBusyPeriod{ 0, startSecs, endSecs } );
+        }
+    }
+}
+
+
+void IcalInterpreter::readEvent(const VEventComponent &inVEventComponent,
                 AppointmentBasics* &outAppBasics,
                 QVector<AppointmentAlarm*>& outAppAlarmVector,
                 AppointmentRecurrence* &outAppRecurrence )
@@ -59,7 +115,7 @@ void IcalInterpreter::readEvent(const VEventComponent inVEventComponent,
     bool haveRecurrence = false;
     bool have_rdate = false;    // rdate is somewhat special, see below...
 
-    for( const Property p : inVEventComponent.m_properties )
+    for( const Property &p : inVEventComponent.m_properties )
     {
         if( p.m_type == Property::PT_DESCRIPTION )
         {
@@ -93,6 +149,12 @@ void IcalInterpreter::readEvent(const VEventComponent inVEventComponent,
             outAppBasics->m_dtEnd = outAppBasics->m_dtStart.addSecs( p.m_contentDuration.toSeconds() );
             continue;
         }
+        if( p.m_type == Property::PT_TRANSP )
+        {
+            outAppBasics->m_busyFree = p.m_contentTransparency == Property::TT_TRANSPARENT ?
+                        AppointmentBasics::FREE : AppointmentBasics::BUSY;
+            continue;
+        }
         if( p.m_type == Property::PT_EXDATE )
         {
             if( not haveRecurrence )
@@ -150,7 +212,7 @@ void IcalInterpreter::readEvent(const VEventComponent inVEventComponent,
         // the above finds out DT_START and DT_END. With this we can find out
         // length of an interval. Here, we can apply this interval length.
         quint64 intervalSeconds = outAppBasics->m_dtStart.secsTo( outAppBasics->m_dtEnd );
-        for( const Property p : inVEventComponent.m_properties )
+        for( const Property &p : inVEventComponent.m_properties )
         {
             if( p.m_type != Property::PT_RDATE )
                 continue;
@@ -166,7 +228,7 @@ void IcalInterpreter::readEvent(const VEventComponent inVEventComponent,
         }
     }
 
-    for( const VAlarmComponent alarm : inVEventComponent.m_vAlarmComponents )
+    for( const VAlarmComponent &alarm : inVEventComponent.m_vAlarmComponents )
     {
         AppointmentAlarm *appAlarm = new AppointmentAlarm();
         readAlarm( alarm, outAppBasics, appAlarm );
@@ -175,11 +237,11 @@ void IcalInterpreter::readEvent(const VEventComponent inVEventComponent,
 }
 
 
-void IcalInterpreter::readAlarm( const VAlarmComponent inVAlarmComponent,
+void IcalInterpreter::readAlarm( const VAlarmComponent &inVAlarmComponent,
                                  const AppointmentBasics* inAppBasics,
                                  AppointmentAlarm* &outAppAlarm )
 {
-    for( const Property p : inVAlarmComponent.m_properties )
+    for( const Property &p : inVAlarmComponent.m_properties )
     {
         if( p.m_type == Property::PT_REPEAT )
         {
@@ -227,13 +289,13 @@ void IcalInterpreter::readAlarm( const VAlarmComponent inVAlarmComponent,
 }
 
 
-void IcalInterpreter::readRecurrenceRDates(const Property inRecurrenceProperty,
+void IcalInterpreter::readRecurrenceRDates(const Property &inRecurrenceProperty,
                 const quint64 inIntervalSecondsToEndDate,
-                const DateTime inStartDateTime,
+                const DateTime &inStartDateTime,
                 AppointmentRecurrence* &outAppRecurrence )
 {
     // only one of both for-loops is executed
-    for( Interval interval : inRecurrenceProperty.m_contentIntervalVector )
+    for( const Interval &interval : inRecurrenceProperty.m_contentIntervalVector )
     {
         DateTime start;
         DateTime end;
@@ -254,7 +316,7 @@ void IcalInterpreter::readRecurrenceRDates(const Property inRecurrenceProperty,
         outAppRecurrence->m_recurFixedIntervals.append( fixedInterval );
     }
 
-    for( DateTime startTime : inRecurrenceProperty.m_contentDateTimeVector )
+    for( const DateTime &startTime : inRecurrenceProperty.m_contentDateTimeVector )
     {
         DateTime newStartDate;
         if( startTime.isDate() )
@@ -277,14 +339,13 @@ void IcalInterpreter::readRecurrenceRDates(const Property inRecurrenceProperty,
 }
 
 
-void IcalInterpreter::readRecurrenceRRule(const Property inRecurrenceProperty,
+void IcalInterpreter::readRecurrenceRRule(const Property &inRecurrenceProperty,
                                       AppointmentRecurrence* &outAppRecurrence  )
 {
     int numberOfByRules = 0;
     // This is more or less just stupid translation between
     // Ical-consts and appointment const with just different names.
-    // More, we limit shortest recurrence to daily.
-    for( const Parameter p : inRecurrenceProperty.m_parameters )
+    for( const Parameter &p : inRecurrenceProperty.m_parameters )
     {
         if( p.m_type == Parameter::RR_FREQ )
         {
@@ -302,7 +363,16 @@ void IcalInterpreter::readRecurrenceRRule(const Property inRecurrenceProperty,
                 case Parameter::F_YEARLY:
                     outAppRecurrence->m_frequency = AppointmentRecurrence::RFT_YEARLY;
                 break;
-                default:    // we limit to the above cases. No shorter recurrence in this program.
+                case Parameter::F_HOURLY:
+                    outAppRecurrence->m_frequency = AppointmentRecurrence::RFT_HOURLY;
+                break;
+                case Parameter::F_MINUTELY:
+                    outAppRecurrence->m_frequency = AppointmentRecurrence::RFT_MINUTELY;
+                break;
+                case Parameter::F_SECONDLY:
+                    outAppRecurrence->m_frequency = AppointmentRecurrence::RFT_SECONDLY;
+                break;
+                default:    // F_NO_FREQUENCY is rejected by eventHasUsableRRuleOrNone()
                 break;
             }
         }
@@ -323,7 +393,7 @@ void IcalInterpreter::readRecurrenceRRule(const Property inRecurrenceProperty,
         else if( p.m_type == Parameter::RR_BYDAY )
         {
             numberOfByRules++;
-            for( const std::pair<Parameter::IcalWeekDayType, int> day : p.m_contentDaySet )
+            for( const std::pair<Parameter::IcalWeekDayType, int> &day : p.m_contentDaySet )
             {
                 Parameter::IcalWeekDayType wd = day.first;
                 AppointmentRecurrence::WeekDay weekDay = AppointmentRecurrence::WeekDay::WD_MO;
@@ -446,26 +516,32 @@ void IcalInterpreter::readRecurrenceRRule(const Property inRecurrenceProperty,
             case AppointmentRecurrence::RFT_YEARLY:
                 outAppRecurrence->m_frequency = AppointmentRecurrence::RFT_SIMPLE_YEARLY;
             break;
-            default:    // we limit to the above cases. No shorter recurrence in this program.
+            default:    // sub-daily rules have no simple form
             break;
         }
     }
 }
 
 
-bool IcalInterpreter::eventHasUsableRRuleOrNone( const VEventComponent inVEventComponent )
+bool IcalInterpreter::eventHasUsableRRuleOrNone( const VEventComponent &inVEventComponent )
 {
     bool ret = true;
-    for( const Property p : inVEventComponent.m_properties )
+    for( const Property &p : inVEventComponent.m_properties )
     {
         if( p.m_type == Property::PT_RRULE )
         {
             Parameter param;
             bool found = p.getParameterByType( Parameter::RR_FREQ, param );
-            if( found and ( param.m_contentFrequency == Parameter::F_SECONDLY or
-                param.m_contentFrequency == Parameter::F_MINUTELY or
-                param.m_contentFrequency == Parameter::F_HOURLY or
-                param.m_contentFrequency == Parameter::F_NO_FREQUENCY ) )
+            // sub-daily rules are fine, they are streamed, see RecurrenceIterator
+            if( found and param.m_contentFrequency == Parameter::F_NO_FREQUENCY )
+                return false;
+            // but counting a huge COUNT would be a walk of its own
+            Parameter countParam;
+            if( found and ( param.m_contentFrequency == Parameter::F_HOURLY or
+                            param.m_contentFrequency == Parameter::F_MINUTELY or
+                            param.m_contentFrequency == Parameter::F_SECONDLY ) and
+                p.getParameterByType( Parameter::RR_COUNT, countParam ) and
+                countParam.m_contentInteger > RecurrenceIterator::MAX_COUNT )
                 return false;
         }
     }
@@ -33,35 +33,43 @@ public:
     IcalInterpreter( QObject* parent = Q_NULLPTR  );
     void readIcal( const ICalBody &inIcal );
 
+    // busy periods of all VFREEBUSY components, valid after readIcal()
+    const QVector<FreeBusyPeriod> &freeBusyPeriods() const;
+
 private:
-    void readEvent( const VEventComponent inVEventComponent,
+    // busy periods of one VFREEBUSY, FBTYPE=FREE is left out
+    void readFreeBusy( const VFreeBusyComponent &inVFreeBusyComponent );
+
+    void readEvent( const VEventComponent &inVEventComponent,
                     AppointmentBasics* &outAppBasics,
                     QVector<AppointmentAlarm*> &outAppAlarmVector,
                     AppointmentRecurrence* &outAppRecurrence );
 
-    void readAlarm( const VAlarmComponent inVAlarmComponent,
+    void readAlarm( const VAlarmComponent &inVAlarmComponent,
                     const AppointmentBasics* inAppBasics,
                     AppointmentAlarm* &outAppAlarm );
 
-    void readRecurrenceRDates( const Property inRecurrenceProperty,
+    void readRecurrenceRDates( const Property &inRecurrenceProperty,
                                const quint64 inIntervalSecondsToEndDate,
-                               const DateTime inStartDateTime,  // for dates, to complete the interval
+                               const DateTime &inStartDateTime,  // for dates, to complete the interval
                                AppointmentRecurrence* &outAppRecurrence );
 
-    void readRecurrenceRRule( const Property inRecurrenceProperty,
+    void readRecurrenceRRule( const Property &inRecurrenceProperty,
                               AppointmentRecurrence* &outAppRecurrence );
 
     /* true, if inVEventComponent has NO RRULE,
      * true, if inVEventComponent has RRule with FREQ >= DAILY
      * else false.
      */
-    bool eventHasUsableRRuleOrNone( const VEventComponent inVEventComponent );
+    bool eventHasUsableRRuleOrNone( const VEventComponent &inVEventComponent );
 
     /* make an appointment and signal it to the outside world */
     void makeAppointment( AppointmentBasics* &inAppBasics,
                           AppointmentRecurrence* &inAppRecurrence,
                           QVector<AppointmentAlarm*>& inAppAlarmVector );
 
+    QVector<FreeBusyPeriod> m_freeBusyPeriods;
+
 signals:
     // each time, an event is generated, tell progress
     void sigTickEvent( const int min, const int current, const int max );
@@ -0,0 +1,238 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef ICALNAMES_H
+#define ICALNAMES_H
+
+#include "parameter.h"
+#include "property.h"
+
+#include <QString>
+
+
+/* Names of properties and parameters, rfc5545#section-3.2 and 3.7 / 3.8, and the
+ *  parts of RRULE, which we read as parameters.
+ * Each content line and each parameter needs its name resolved, so the names are kept
+ *  in a perfect hash table, which the compiler builds from NAMES. A name is folded to
+ *  uppercase once while it is hashed, then it is compared to one table entry at most.
+ */
+namespace IcalNames
+{
+
+struct Name
+{
+    const char*                     m_name;             // uppercase
+    Property::IcalPropertyType      m_propertyType;     // PT_PROPERTY_UNKNOWN, if no property
+    Parameter::IcalParameterType    m_parameterType;    // OTHERPARAM, if no parameter
+};
+
+static constexpr Name NAMES[] = {
+    // properties
+    { "ACTION",             Property::PT_ACTION,            Parameter::OTHERPARAM },
+    { "ATTACH",             Property::PT_ATTACH,            Parameter::OTHERPARAM },
+    { "ATTENDEE",           Property::PT_ATTENDEE,          Parameter::OTHERPARAM },
+    { "CALSCALE",           Property::PT_CALSCALE,          Parameter::OTHERPARAM },
+    { "CATEGORIES",         Property::PT_CATEGORIES,        Parameter::OTHERPARAM },
+    { "CLASS",              Property::PT_CLASS,             Parameter::OTHERPARAM },
+    { "COMMENT",            Property::PT_COMMENT,           Parameter::OTHERPARAM },
+    { "COMPLETED",          Property::PT_COMPLETED,         Parameter::OTHERPARAM },
+    { "CONTACT",            Property::PT_CONTACT,           Parameter::OTHERPARAM },
+    { "CREATED",            Property::PT_CREATED,           Parameter::OTHERPARAM },
+    { "DESCRIPTION",        Property::PT_DESCRIPTION,       Parameter::OTHERPARAM },
+    { "DTEND",              Property::PT_DTEND,             Parameter::OTHERPARAM },
+    { "DTSTAMP",            Property::PT_DTSTAMP,           Parameter::OTHERPARAM },
+    { "DTSTART",            Property::PT_DTSTART,           Parameter::OTHERPARAM },
+    { "DUE",                Property::PT_DUE,               Parameter::OTHERPARAM },
+    { "DURATION",           Property::PT_DURATION,          Parameter::OTHERPARAM },
+    { "EXDATE",             Property::PT_EXDATE,            Parameter::OTHERPARAM },
+    { "FREEBUSY",           Property::PT_FREEBUSY,          Parameter::OTHERPARAM },
+    { "GEO",                Property::PT_GEO,               Parameter::OTHERPARAM },
+    { "LAST-MODIFIED",      Property::PT_LAST_MODIFIED,     Parameter::OTHERPARAM },
+    { "LOCATION",           Property::PT_LOCATION,          Parameter::OTHERPARAM },
+    { "METHOD",             Property::PT_METHOD,            Parameter::OTHERPARAM },
+    { "ORGANIZER",          Property::PT_ORGANIZER,         Parameter::OTHERPARAM },
+    { "PERCENT-COMPLETE",   Property::PT_PERCENT_COMPLETE,  Parameter::OTHERPARAM },
+    { "PRIORITY",           Property::PT_PRIORITY,          Parameter::OTHERPARAM },
+    { "PRODID",             Property::PT_PRODID,            Parameter::OTHERPARAM },
+    { "RDATE",              Property::PT_RDATE,             Parameter::OTHERPARAM },
+    { "RECURRENCE-ID",      Property::PT_RECURRENCE_ID,     Parameter::OTHERPARAM },
+    { "RELATED-TO",         Property::PT_RELATED_TO,        Parameter::OTHERPARAM },
+    { "REPEAT",             Property::PT_REPEAT,            Parameter::OTHERPARAM },
+    { "REQUEST-STATUS",     Property::PT_REQUEST_STATUS,    Parameter::OTHERPARAM },
+    { "RESOURCES",          Property::PT_RESOURCES,         Parameter::OTHERPARAM },
+    { "RRULE",              Property::PT_RRULE,             Parameter::OTHERPARAM },
+    { "SEQUENCE",           Property::PT_SEQUENCE,          Parameter::OTHERPARAM },
+    { "STATUS",             Property::PT_STATUS,            Parameter::OTHERPARAM },
+    { "SUMMARY",            Property::PT_SUMMARY,           Parameter::OTHERPARAM },
+    { "TRANSP",             Property::PT_TRANSP,            Parameter::OTHERPARAM },
+    { "TRIGGER",            Property::PT_TRIGGER,           Parameter::OTHERPARAM },
+    { "TZID",               Property::PT_TZID,              Parameter::TZIDPARAM },
+    { "TZNAME",             Property::PT_TZNAME,            Parameter::OTHERPARAM },
+    { "TZOFFSETFROM",       Property::PT_TZOFFSETFROM,      Parameter::OTHERPARAM },
+    { "TZOFFSETTO",         Property::PT_TZOFFSETTO,        Parameter::OTHERPARAM },
+    { "TZURL",              Property::PT_TZURL,             Parameter::OTHERPARAM },
+    { "UID",                Property::PT_UID,               Parameter::OTHERPARAM },
+    { "URL",                Property::PT_URL,               Parameter::OTHERPARAM },
+    { "VERSION",            Property::PT_VERSION,           Parameter::OTHERPARAM },
+    // parameters
+    { "ALTREP",             Property::PT_PROPERTY_UNKNOWN,  Parameter::ALTREPPARAM },
+    { "CN",                 Property::PT_PROPERTY_UNKNOWN,  Parameter::CNPARAM },
+    { "CUTYPE",             Property::PT_PROPERTY_UNKNOWN,  Parameter::CUTYPEPARAM },
+    { "DELEGATED-FROM",     Property::PT_PROPERTY_UNKNOWN,  Parameter::DELFROMPARAM },
+    { "DELEGATED-TO",       Property::PT_PROPERTY_UNKNOWN,  Parameter::DELTOPARAM },
+    { "DIR",                Property::PT_PROPERTY_UNKNOWN,  Parameter::DIRPARAM },
+    { "ENCODING",           Property::PT_PROPERTY_UNKNOWN,  Parameter::ENCODINGPARAM },
+    { "FMTTYPE",            Property::PT_PROPERTY_UNKNOWN,  Parameter::FMTTYPEPARAM },
+    { "FBTYPE",             Property::PT_PROPERTY_UNKNOWN,  Parameter::FBTYPEPARAM },
+    { "LANGUAGE",           Property::PT_PROPERTY_UNKNOWN,  Parameter::LANGUAGEPARAM },
+    { "MEMBER",             Property::PT_PROPERTY_UNKNOWN,  Parameter::MEMBERPARAM },
+    { "PARTSTAT",           Property::PT_PROPERTY_UNKNOWN,  Parameter::PARTSTATPARAM },
+    { "RANGE",              Property::PT_PROPERTY_UNKNOWN,  Parameter::RANGEPARAM },
+    { "RELATED",            Property::PT_PROPERTY_UNKNOWN,  Parameter::TRIGRELPARAM },
+    { "RELTYPE",            Property::PT_PROPERTY_UNKNOWN,  Parameter::RELTYPEPARAM },
+    { "ROLE",               Property::PT_PROPERTY_UNKNOWN,  Parameter::ROLEPARAM },
+    { "RSVP",               Property::PT_PROPERTY_UNKNOWN,  Parameter::RSVPPARAM },
+    { "SENT-BY",            Property::PT_PROPERTY_UNKNOWN,  Parameter::SENTBYPARAM },
+    { "VALUE",              Property::PT_PROPERTY_UNKNOWN,  Parameter::VALUETYPEPARAM },
+    // parts of RRULE
+    { "FREQ",               Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_FREQ },
+    { "UNTIL",              Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_UNTIL },
+    { "COUNT",              Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_COUNT },
+    { "INTERVAL",           Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_INTERVAL },
+    { "BYSECOND",           Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_BYSECOND },
+    { "BYMINUTE",           Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_BYMINUTE },
+    { "BYHOUR",             Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_BYHOUR },
+    { "BYDAY",              Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_BYDAY },
+    { "BYMONTHDAY",         Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_BYMONTHDAY },
+    { "BYYEARDAY",          Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_BYYEARDAY },
+    { "BYWEEKNO",           Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_BYWEEKNO },
+    { "BYMONTH",            Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_BYMONTH },
+    { "BYSETPOS",           Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_BYSETPOS },
+    { "WKST",               Property::PT_PROPERTY_UNKNOWN,  Parameter::RR_WKST },
+};
+
+static constexpr int NUM_NAMES = sizeof( NAMES ) / sizeof( NAMES[0] );
+static constexpr int MAX_NAME_LENGTH = 16;          // PERCENT-COMPLETE
+static constexpr unsigned int TABLE_SIZE = 1024;    // power of 2, with room to find a seed quickly
+static constexpr unsigned char NO_NAME = 0xFF;
+
+static_assert( NUM_NAMES < NO_NAME, "table index does not fit into a byte" );
+
+
+// one step of FNV-1a
+constexpr unsigned int hashStep( const unsigned int inHash, const char inChar )
+{
+    return ( inHash ^ static_cast<unsigned char>( inChar ) ) * 16777619u;
+}
+
+
+constexpr unsigned int hashName( const unsigned int inSeed, const char* inName )
+{
+    unsigned int hash = inSeed;
+    for( int i = 0; inName[i] != '\0'; i++ )
+        hash = hashStep( hash, inName[i] );
+    return hash;
+}
+
+
+struct Table
+{
+    unsigned int    m_seed;
+    unsigned char   m_slots[TABLE_SIZE];    // index into NAMES or NO_NAME
+};
+
+
+// tries seeds until all names hash to different slots
+constexpr Table buildTable()
+{
+    for( unsigned int seed = 2166136261u; ; seed++ )
+    {
+        Table table{ seed, {} };
+        for( unsigned char &slot : table.m_slots )
+            slot = NO_NAME;
+        bool collision = false;
+        for( int n = 0; n < NUM_NAMES and not collision; n++ )
+        {
+            unsigned char &slot = table.m_slots[hashName( seed, NAMES[n].m_name ) & ( TABLE_SIZE - 1 )];
+            if( slot == NO_NAME )
+                slot = static_cast<unsigned char>( n );
+            else
+                collision = true;
+        }
+        if( not collision )
+            return table;
+    }
+}
+
+static constexpr Table TABLE = buildTable();
+
+
+// the entry of inName in any case, nullptr if unknown
+inline const Name* find( const QString &inName )
+{
+    const int length = inName.size();
+    if( length == 0 or length > MAX_NAME_LENGTH )
+        return nullptr;
+    char upper[MAX_NAME_LENGTH];
+    unsigned int hash = TABLE.m_seed;
+    const QChar* chars = inName.constData();
+    for( int i = 0; i < length; i++ )
+    {
+        ushort c = chars[i].unicode();
+        if( c == 0 or c >= 128 )
+            return nullptr;
+        if( c >= 'a' and c <= 'z' )
+            c -= 'a' - 'A';
+        upper[i] = static_cast<char>( c );
+        hash = hashStep( hash, upper[i] );
+    }
+    const unsigned char index = TABLE.m_slots[hash & ( TABLE_SIZE - 1 )];
+    if( index == NO_NAME )
+        return nullptr;
+    const char* name = NAMES[index].m_name;
+    for( int i = 0; i < length; i++ )
+        if( name[i] != upper[i] )
+            return nullptr;
+    return name[length] == '\0' ? &NAMES[index] : nullptr;
+}
+
+
+inline Property::IcalPropertyType propertyType( const QString &inName )
+{
+    const Name* name = find( inName );
+    return name ? name->m_propertyType : Property::PT_PROPERTY_UNKNOWN;
+}
+
+
+inline Parameter::IcalParameterType parameterType( const QString &inName )
+{
+    const Name* name = find( inName );
+    return name ? name->m_parameterType : Parameter::OTHERPARAM;
+}
+
+
+// uppercase name of a property, nullptr for PT_PROPERTY_UNKNOWN
+inline const char* propertyName( const Property::IcalPropertyType inType )
+{
+    for( const Name &name : NAMES )
+        if( name.m_propertyType == inType and inType != Property::PT_PROPERTY_UNKNOWN )
+            return name.m_name;
+    return nullptr;
+}
+
+} // namespace IcalNames
+
+#endif // ICALNAMES_H
@@ -0,0 +1,341 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "icalwriter.h"
+#include "property.h"
+
+#include <QDebug>
+#include <QStringList>
+
+#include <algorithm>
+
+
+// RFC 5545, 3.1: lines SHOULD NOT be longer than 75 octets, excluding the line break
+static const int MAX_LINE_OCTETS = 75;
+// output buffer is written to the device, when it reaches this size
+static const int FLUSH_OCTETS = 64 * 1024;
+// appointments loaded at once by writeStorage()
+static const int EXPORT_BATCH_SIZE = 256;
+
+
+// date-time value, for local times without the TZID parameter
+static QString dateTimeValue( const DateTime &inDt )
+{
+    if( inDt.isDate() )
+        return inDt.toDtString();
+    if( inDt.isUtc() or inDt.timeSpec() == Qt::UTC )
+        return inDt.toUTC().toString( "yyyyMMddThhmmss" ).append( 'Z' );
+    return inDt.toDtString();
+}
+
+
+// ";VALUE=DATE", ";TZID=..." or nothing
+static QString dateTimeParameters( const DateTime &inDt )
+{
+    if( inDt.isDate() )
+        return QString( ";VALUE=DATE" );
+    if( inDt.isUtc() or inDt.timeSpec() != Qt::TimeZone or not inDt.timeZone().isValid() )
+        return QString();
+    return QString( ";TZID=%1" ).arg( QString( inDt.timeZone().id() ) );
+}
+
+
+// UNTIL has to be in UTC, if DTSTART has a time zone
+static QString untilValue( const DateTime &inDt )
+{
+    if( inDt.isDate() or inDt.timeSpec() == Qt::LocalTime )
+        return inDt.toDtString();
+    return inDt.toUTC().toString( "yyyyMMddThhmmss" ).append( 'Z' );
+}
+
+
+static QString durationValue( const qint64 inSecs )
+{
+    qint64 secs = qAbs( inSecs );
+    QString s = inSecs < 0 ? "-P" : "P";
+    if( secs >= 86400 )
+    {
+        s += QString( "%1D" ).arg( secs / 86400 );
+        secs %= 86400;
+        if( secs == 0 )
+            return s;
+    }
+    s += 'T';
+    if( secs >= 3600 )
+        s += QString( "%1H" ).arg( secs / 3600 );
+    if( secs % 3600 >= 60 )
+        s += QString( "%1M" ).arg( ( secs % 3600 ) / 60 );
+    if( secs % 60 != 0 or secs == 0 )
+        s += QString( "%1S" ).arg( secs % 60 );
+    return s;
+}
+
+
+static QString weekDayValue( const AppointmentRecurrence::WeekDay inWeekDay )
+{
+    switch( inWeekDay )
+    {
+        case AppointmentRecurrence::WD_MO:  return "MO";
+        case AppointmentRecurrence::WD_TU:  return "TU";
+        case AppointmentRecurrence::WD_WE:  return "WE";
+        case AppointmentRecurrence::WD_TH:  return "TH";
+        case AppointmentRecurrence::WD_FR:  return "FR";
+        case AppointmentRecurrence::WD_SA:  return "SA";
+        case AppointmentRecurrence::WD_SU:  return "SU";
+    }
+    return "MO";
+}
+
+
+// ";BYxxx=1,2,3" in ascending order, nothing for an empty set
+static QString intListRule( const char* inName, const QSet<int> &inSet )
+{
+    if( inSet.isEmpty() )
+        return QString();
+    QList<int> values = inSet.values();
+    std::sort( values.begin(), values.end() );
+    QStringList list;
+    for( const int v : values )
+        list.append( QString::number( v ) );
+    return QString( ";%1=%2" ).arg( inName ).arg( list.join( ',' ) );
+}
+
+
+IcalWriter::IcalWriter( QIODevice* inDevice )
+    :
+      m_device( inDevice ),
+      m_hasErrors( false )
+{
+    // reserved capacity survives resize(0), so the buffer is allocated once
+    m_buffer.reserve( FLUSH_OCTETS + 4096 );
+}
+
+
+void IcalWriter::begin()
+{
+    m_dtStamp = QDateTime::currentDateTimeUtc().toString( "yyyyMMddThhmmss" ).append( 'Z' );
+    writeContentLine( "BEGIN:VCALENDAR" );
+    writeContentLine( "VERSION:2.0" );
+    writeContentLine( "PRODID:-//Daylight//Daylight Calendar//EN" );
+    writeContentLine( "CALSCALE:GREGORIAN" );
+}
+
+
+void IcalWriter::writeAppointment( const Appointment* inApp )
+{
+    const AppointmentBasics* basics = inApp->m_appBasics;
+    if( basics == nullptr )
+        return;
+
+    writeContentLine( "BEGIN:VEVENT" );
+    writeContentLine( QString( "UID:%1" ).arg( inApp->m_uid ) );
+    writeContentLine( QString( "DTSTAMP:%1" ).arg( m_dtStamp ) );
+    writeDateTimeProperty( "DTSTART", basics->m_dtStart );
+    if( basics->m_dtEnd.isValid() )
+        writeDateTimeProperty( "DTEND", basics->m_dtEnd );
+    if( basics->m_sequence > 0 )
+        writeContentLine( QString( "SEQUENCE:%1" ).arg( basics->m_sequence ) );
+    writeContentLine( QString( "SUMMARY:%1" ).arg( Property::escapeText( basics->m_summary ) ) );
+    if( not basics->m_description.isEmpty() )
+        writeContentLine( QString( "DESCRIPTION:%1" ).arg( Property::escapeText( basics->m_description ) ) );
+    if( basics->m_busyFree == AppointmentBasics::FREE )
+        writeContentLine( "TRANSP:TRANSPARENT" );
+
+    if( inApp->m_haveRecurrence and inApp->m_appRecurrence )
+        writeRecurrence( inApp->m_appRecurrence, basics );
+
+    for( const AppointmentAlarm* alarm : inApp->m_appAlarms )
+        writeAlarm( alarm, basics );
+
+    writeContentLine( "END:VEVENT" );
+}
+
+
+bool IcalWriter::end()
+{
+    writeContentLine( "END:VCALENDAR" );
+    flush();
+    return not m_hasErrors;
+}
+
+
+int IcalWriter::writeStorage( Storage* inStorage )
+{
+    int numAppointments = 0;
+    QString lastUid;
+    QVector<Appointment*> batch;
+    begin();
+    while( inStorage->loadAppointmentBatch( lastUid, EXPORT_BATCH_SIZE, batch ) > 0 )
+    {
+        for( Appointment* app : batch )
+        {
+            writeAppointment( app );
+            delete app;
+        }
+        numAppointments += batch.count();
+    }
+    if( not end() )
+        return -1;
+    return numAppointments;
+}
+
+
+void IcalWriter::writeDateTimeProperty( const QString &inName, const DateTime &inDt )
+{
+    writeContentLine( QString( "%1%2:%3" ).arg( inName )
+                      .arg( dateTimeParameters( inDt ) ).arg( dateTimeValue( inDt ) ) );
+}
+
+
+void IcalWriter::writeRecurrence( const AppointmentRecurrence* inRecurrence, const AppointmentBasics* inBasics )
+{
+    QString freq;
+    bool simple = false;
+    switch( inRecurrence->m_frequency )
+    {
+        case AppointmentRecurrence::RFT_FIXED_DATES:                        break;
+        case AppointmentRecurrence::RFT_SIMPLE_YEARLY:  simple = true;      // fall through
+        case AppointmentRecurrence::RFT_YEARLY:         freq = "YEARLY";    break;
+        case AppointmentRecurrence::RFT_SIMPLE_MONTHLY: simple = true;      // fall through
+        case AppointmentRecurrence::RFT_MONTHLY:        freq = "MONTHLY";   break;
+        case AppointmentRecurrence::RFT_SIMPLE_WEEKLY:  simple = true;      // fall through
+        case AppointmentRecurrence::RFT_WEEKLY:         freq = "WEEKLY";    break;
+        case AppointmentRecurrence::RFT_SIMPLE_DAILY:   simple = true;      // fall through
+        case AppointmentRecurrence::RFT_DAILY:          freq = "DAILY";     break;
+        case AppointmentRecurrence::RFT_HOURLY:         freq = "HOURLY";    break;
+        case AppointmentRecurrence::RFT_MINUTELY:       freq = "MINUTELY";  break;
+        case AppointmentRecurrence::RFT_SECONDLY:       freq = "SECONDLY";  break;
+    }
+
+    if( not freq.isEmpty() )
+    {
+        QString rule = QString( "RRULE:FREQ=%1" ).arg( freq );
+        if( inRecurrence->m_interval > 1 )
+            rule += QString( ";INTERVAL=%1" ).arg( inRecurrence->m_interval );
+        if( inRecurrence->m_haveCount )
+            rule += QString( ";COUNT=%1" ).arg( inRecurrence->m_count );
+        else if( inRecurrence->m_haveUntil )
+            rule += QString( ";UNTIL=%1" ).arg( untilValue( inRecurrence->m_until ) );
+        // simple rules have no BYxxx at all, any of them would make the reader take the long way
+        if( not simple )
+        {
+            rule += intListRule( "BYMONTH", inRecurrence->m_byMonthSet );
+            rule += intListRule( "BYWEEKNO", inRecurrence->m_byWeekNumberSet );
+            rule += intListRule( "BYYEARDAY", inRecurrence->m_byYearDaySet );
+            rule += intListRule( "BYMONTHDAY", inRecurrence->m_byMonthDaySet );
+            if( not inRecurrence->m_byDaySet.empty() )
+            {
+                QStringList days;
+                for( const std::pair<AppointmentRecurrence::WeekDay, int> &day : inRecurrence->m_byDaySet )
+                {
+                    if( day.second == 0 )
+                        days.append( weekDayValue( day.first ) );
+                    else
+                        days.append( QString( "%1%2" ).arg( day.second ).arg( weekDayValue( day.first ) ) );
+                }
+                rule += QString( ";BYDAY=%1" ).arg( days.join( ',' ) );
+            }
+            rule += intListRule( "BYHOUR", inRecurrence->m_byHourSet );
+            rule += intListRule( "BYMINUTE", inRecurrence->m_byMinuteSet );
+            rule += intListRule( "BYSECOND", inRecurrence->m_bySecondSet );
+            rule += intListRule( "BYSETPOS", inRecurrence->m_bySetPosSet );
+            rule += QString( ";WKST=%1" ).arg( weekDayValue( inRecurrence->m_startWeekday ) );
+        }
+        writeContentLine( rule );
+    }
+
+    // one line each, as every date may have its own time zone
+    for( const DateTime &exDate : inRecurrence->m_exceptionDates )
+        writeDateTimeProperty( "EXDATE", exDate );
+
+    /* RDATEs are intervals. With the length of the appointment itself, the
+     *  start is enough, otherwise it becomes a PERIOD. */
+    const qint64 appSecs = inBasics->m_dtStart.secsTo( inBasics->m_dtEnd );
+    for( const RecurringFixedIntervals &interval : inRecurrence->m_recurFixedIntervals )
+    {
+        if( interval.m_start.isDate() or interval.m_start.secsTo( interval.m_end ) == appSecs )
+            writeDateTimeProperty( "RDATE", interval.m_start );
+        else
+            writeContentLine( QString( "RDATE;VALUE=PERIOD%1:%2/%3" )
+                              .arg( dateTimeParameters( interval.m_start ) )
+                              .arg( dateTimeValue( interval.m_start ) )
+                              .arg( dateTimeValue( interval.m_end ) ) );
+    }
+}
+
+
+void IcalWriter::writeAlarm( const AppointmentAlarm* inAlarm, const AppointmentBasics* inBasics )
+{
+    writeContentLine( "BEGIN:VALARM" );
+    writeContentLine( "ACTION:DISPLAY" );
+    writeContentLine( QString( "DESCRIPTION:%1" ).arg( Property::escapeText( inBasics->m_summary ) ) );
+    writeContentLine( QString( "TRIGGER:%1" ).arg( durationValue( inAlarm->m_alarmSecs ) ) );
+    // REPEAT and DURATION only come together
+    if( inAlarm->m_repeatNumber > 0 and inAlarm->m_pauseSecs > 0 )
+    {
+        writeContentLine( QString( "REPEAT:%1" ).arg( inAlarm->m_repeatNumber ) );
+        writeContentLine( QString( "DURATION:%1" ).arg( durationValue( static_cast<qint64>(inAlarm->m_pauseSecs) ) ) );
+    }
+    writeContentLine( "END:VALARM" );
+}
+
+
+void IcalWriter::writeContentLine( const QString &inLine )
+{
+    const QByteArray utf8 = inLine.toUtf8();
+    if( utf8.size() <= MAX_LINE_OCTETS )
+        m_buffer.append( utf8 );
+    else
+    {
+        int lineOctets = 0;
+        int i = 0;
+        while( i < utf8.size() )
+        {
+            // length of the UTF-8 sequence, which starts here
+            const uchar c = static_cast<uchar>( utf8.at( i ) );
+            int charOctets = 1;
+            if( c >= 0xF0 )         charOctets = 4;
+            else if( c >= 0xE0 )    charOctets = 3;
+            else if( c >= 0xC0 )    charOctets = 2;
+            charOctets = qMin( charOctets, utf8.size() - i );
+
+            if( lineOctets + charOctets > MAX_LINE_OCTETS )
+            {
+                m_buffer.append( "\r\n " );
+                lineOctets = 1;     // the space
+            }
+            m_buffer.append( utf8.constData() + i, charOctets );
+            lineOctets += charOctets;
+            i += charOctets;
+        }
+    }
+    m_buffer.append( "\r\n" );
+    if( m_buffer.size() >= FLUSH_OCTETS )
+        flush();
+}
+
+
+void IcalWriter::flush()
+{
+    if( m_buffer.isEmpty() )
+        return;
+    if( m_device->write( m_buffer ) != m_buffer.size() )
+    {
+        qDebug() << "ERR: IcalWriter::flush(): " << m_device->errorString();
+        m_hasErrors = true;
+    }
+    m_buffer.resize( 0 );
+}
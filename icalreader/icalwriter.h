@@ -0,0 +1,67 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef ICALWRITER_H
+#define ICALWRITER_H
+
+#include "appointmentmanager.h"
+#include "datetime.h"
+#include "storage.h"
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+
+
+/* Counterpart of IcalInterpreter: writes appointments as an RFC 5545 ical file.
+ * Content lines are folded after 75 octets, without splitting UTF-8 sequences.
+ * Everything goes through one output buffer, which is flushed to the device each time it
+ *  is full and then reused, so memory stays flat for any number of appointments.
+ * Time zones are written as TZID with their IANA name, which is what the reader looks up.
+ *  VTIMEZONE components are not written.
+ *
+ * Usage: begin(), writeAppointment() for each appointment, end(). writeStorage() does all of
+ *  it for every appointment in a Storage.
+ */
+class IcalWriter
+{
+public:
+    // inDevice is open for writing and not owned
+    explicit IcalWriter( QIODevice* inDevice );
+
+    void begin();
+    void writeAppointment( const Appointment* inApp );
+    // false, if writing failed somewhere
+    bool end();
+
+    // whole calendar out of inStorage, loaded in batches. Returns the number of appointments, -1 on error
+    int writeStorage( Storage* inStorage );
+
+private:
+    void writeDateTimeProperty( const QString &inName, const DateTime &inDt );
+    void writeRecurrence( const AppointmentRecurrence* inRecurrence, const AppointmentBasics* inBasics );
+    void writeAlarm( const AppointmentAlarm* inAlarm, const AppointmentBasics* inBasics );
+    // appends a complete content line with folding and CRLF
+    void writeContentLine( const QString &inLine );
+    void flush();
+
+    QIODevice*  m_device;
+    QByteArray  m_buffer;
+    QString     m_dtStamp;      // same DTSTAMP for all VEVENTs of a file
+    bool        m_hasErrors;
+};
+
+#endif // ICALWRITER_H
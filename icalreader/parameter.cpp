@@ -16,13 +16,30 @@
 */
 
 #include "parameter.h"
+#include "icalnames.h"
 
 #include <QDebug>
+#include <QHash>
 #include <QRegularExpression>
 #include <QRegularExpressionMatch>
 #include <QStringList>
 
 
+/* Every DTSTART and DTEND of a file names the same few time zones. Looking them up
+ * in the system database once per import thread is enough. The cache and its
+ * strings are released, when the import thread ends. */
+static QTimeZone cachedTimeZone( const QString &inTzId )
+{
+    static thread_local QHash<QString, QTimeZone> timeZones;
+    QHash<QString, QTimeZone>::const_iterator it = timeZones.constFind( inTzId );
+    if( it != timeZones.constEnd() )
+        return it.value();
+    QTimeZone tz( inTzId.toUtf8() );
+    timeZones.insert( inTzId, tz );
+    return tz;
+}
+
+
 Parameter::Parameter()
     :
       m_hasErrors(false),
@@ -70,13 +87,13 @@ QString Parameter::contentToString() const
         case PST_DATETIME:      ret += m_contentDateTime.toString(); break;
         case PST_STRINGLIST:
         {
-            for( const QString s : m_contentStringList )
+            for( const QString &s : m_contentStringList )
                 ret += ret.append( s ).append( ',' );
         }
         break;
         case PST_DAYSET:
         {
-            for( const std::pair<IcalWeekDayType, int> dayElem : m_contentDaySet )
+            for( const std::pair<IcalWeekDayType, int> &dayElem : m_contentDaySet )
             {
                 QString s( "(%1:%2),");
                 s = s.arg( static_cast<int>(dayElem.first) ).arg( dayElem.second );
@@ -126,8 +143,11 @@ bool Parameter::readParameter( const QString s )
         return false;
     }
 
+    // name lookup folds case once, see IcalNames
+    const IcalParameterType nameType = IcalNames::parameterType( paramName );
+
     // Example: ALTREP="CID:part3.msg.970415T083000@example.com"
-    if( paramName.compare( "ALTREP", Qt::CaseInsensitive ) == 0 )
+    if( nameType == ALTREPPARAM )
     {
         stripQuotes( argument );
         m_storageType = PST_STRING;
@@ -137,7 +157,7 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: CN="John Smith"
-    if( paramName.compare( "CN", Qt::CaseInsensitive ) == 0 )
+    if( nameType == CNPARAM )
     {
         stripQuotes( argument );
         m_storageType = PST_STRING;
@@ -147,7 +167,7 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: CUTYPE=GROUP
-    if( paramName.compare( "CUTYPE", Qt::CaseInsensitive ) == 0 )
+    if( nameType == CUTYPEPARAM )
     {
         m_storageType = PST_CUTYPE;
         m_content = argument.toUpper();
@@ -167,7 +187,7 @@ bool Parameter::readParameter( const QString s )
 
     // Example: DELEGATED-FROM="mailto:jsmith@example.com"
     // Argument might be a comma separated list
-    if( paramName.compare( "DELEGATED-FROM", Qt::CaseInsensitive ) == 0 )
+    if( nameType == DELFROMPARAM )
     {
         m_storageType = PST_STRING;
         m_content = argument;
@@ -184,7 +204,7 @@ bool Parameter::readParameter( const QString s )
     // Example: DELEGATED-TO="mailto:jdoe@example.com",
     //                       "mailto:jqpublic@example.com"
     // Argument might be a comma separated list
-    if( paramName.compare( "DELEGATED-TO", Qt::CaseInsensitive ) == 0 )
+    if( nameType == DELTOPARAM )
     {
         m_storageType = PST_STRING;
         m_content = argument;
@@ -199,7 +219,7 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: DIR="ldap://example.com:6666/o=ABC%20Industries,c=US"
-    if( paramName.compare( "DIR", Qt::CaseInsensitive ) == 0 )
+    if( nameType == DIRPARAM )
     {
         m_storageType = PST_STRING;
         stripQuotes( argument );
@@ -211,7 +231,7 @@ bool Parameter::readParameter( const QString s )
     // Example: ENCODING=BASE64
     // Please note, that we don't read attachments. So this parameter
     // might never occur.
-    if( paramName.compare( "ENCODING", Qt::CaseInsensitive ) == 0 )
+    if( nameType == ENCODINGPARAM )
     {
         m_storageType = PST_STRING;
         m_content = argument.toUpper();
@@ -222,7 +242,7 @@ bool Parameter::readParameter( const QString s )
     // Example: FMTTYPE=text/plain
     // Please note, that we don't read attachments. So this parameter
     // might never occur.
-    if( paramName.compare( "FMTTYPE", Qt::CaseInsensitive ) == 0 )
+    if( nameType == FMTTYPEPARAM )
     {
         m_storageType = PST_STRING;
         m_content = argument;
@@ -231,7 +251,7 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: FBTYPE=BUSY
-    if( paramName.compare( "FBTYPE", Qt::CaseInsensitive ) == 0 )
+    if( nameType == FBTYPEPARAM )
     {
         m_storageType = PST_STRING;
         m_content = argument.toUpper();
@@ -240,7 +260,7 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: LANGUAGE=en
-    if( paramName.compare( "LANGUAGE", Qt::CaseInsensitive ) == 0 )
+    if( nameType == LANGUAGEPARAM )
     {
         m_storageType = PST_STRING;
         m_content = argument;
@@ -250,7 +270,7 @@ bool Parameter::readParameter( const QString s )
 
     // Example: MEMBER="mailto:aa@example.com","mailto:ab@example.com"
     // Argument might be a comma separated list
-    if( paramName.compare( "MEMBER", Qt::CaseInsensitive ) == 0 )
+    if( nameType == MEMBERPARAM )
     {
         m_storageType = PST_STRING;
         m_content = argument;
@@ -265,7 +285,7 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: PARTSTAT=DECLINED
-    if( paramName.compare( "PARTSTAT", Qt::CaseInsensitive ) == 0 )
+    if( nameType == PARTSTATPARAM )
     {
         m_storageType = PST_PARTSTAT;
         m_content = argument.toUpper();
@@ -286,7 +306,7 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: RANGE=THISANDFUTURE
-    if( paramName.compare( "RANGE", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RANGEPARAM )
     {
         m_storageType = PST_STRING;
         m_content = argument.toUpper();
@@ -301,7 +321,7 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: RELATED=END
-    if( paramName.compare( "RELATED", Qt::CaseInsensitive ) == 0 )
+    if( nameType == TRIGRELPARAM )
     {
         m_storageType = PST_TRIGREL;
         m_content = argument.toUpper();
@@ -318,7 +338,7 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: RELTYPE=SIBLING
-    if( paramName.compare( "RELTYPE", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RELTYPEPARAM )
     {
         m_storageType = PST_RELTYPEPARAM;
         m_content = argument.toUpper();
@@ -335,7 +355,7 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: ROLE=CHAIR
-    if( paramName.compare( "ROLE", Qt::CaseInsensitive ) == 0 )
+    if( nameType == ROLEPARAM )
     {
         m_storageType = PST_ROLEPARAM;
         m_content = argument.toUpper();
@@ -353,7 +373,7 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: RSVP=TRUE
-    if( paramName.compare( "RSVP", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RSVPPARAM )
     {
         m_content = argument.toUpper();
         m_type = RSVPPARAM;
@@ -370,7 +390,7 @@ bool Parameter::readParameter( const QString s )
 
     // Example: SENT-BY="mailto:sray@example.com"
     // just a single address
-    if( paramName.compare( "SENT-BY", Qt::CaseInsensitive ) == 0 )
+    if( nameType == SENTBYPARAM )
     {
         m_storageType = PST_STRING;
         stripQuotes( argument );
@@ -380,12 +400,12 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: TZID=America/New_York
-    if( paramName.compare( "TZID", Qt::CaseInsensitive ) == 0 )
+    if( nameType == TZIDPARAM )
     {
         m_storageType = PST_STRING;
         m_content = argument;
         m_type = TZIDPARAM;
-        QTimeZone tz( m_content.toUtf8() );
+        QTimeZone tz = cachedTimeZone( m_content );
         if( tz.isValid() )
         {
             m_contentTimeZone = tz;
@@ -397,7 +417,7 @@ bool Parameter::readParameter( const QString s )
     }
 
     // Example: VALUE=BINARY
-    if( paramName.compare( "VALUE", Qt::CaseInsensitive ) == 0 )
+    if( nameType == VALUETYPEPARAM )
     {
         m_storageType = PST_VALUES;
         m_content = argument;
@@ -426,7 +446,7 @@ bool Parameter::readParameter( const QString s )
     // --------------------
     // for recurrence rule:
 
-    if( paramName.compare( "FREQ", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_FREQ )
     {
         m_content = argument.toUpper();
         m_type = RR_FREQ;
@@ -448,7 +468,7 @@ bool Parameter::readParameter( const QString s )
         return true;
     }
 
-    if( paramName.compare( "UNTIL", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_UNTIL )
     {
         m_content = argument.toUpper();
         m_type = RR_UNTIL;
@@ -463,7 +483,7 @@ bool Parameter::readParameter( const QString s )
         return false;
     }
 
-    if( paramName.compare( "COUNT", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_COUNT )
     {
         m_content = argument;
         m_type = RR_COUNT;
@@ -479,7 +499,7 @@ bool Parameter::readParameter( const QString s )
         return false;
     }
 
-    if( paramName.compare( "INTERVAL", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_INTERVAL )
     {
         m_content = argument;
         m_type = RR_INTERVAL;
@@ -495,14 +515,14 @@ bool Parameter::readParameter( const QString s )
         return false;
     }
 
-    if( paramName.compare( "BYSECOND", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_BYSECOND )
     {
         m_content = argument;
         m_type = RR_BYSECOND;
         bool ret = true;
         bool ok = false;
         int value;
-        for( const QString s : m_content.split( ',', QString::SkipEmptyParts ) )
+        for( const QString &s : m_content.split( ',', QString::SkipEmptyParts ) )
         {
             value = s.toInt( &ok );
             ret = ok and ( value >= 0 ) and ( value <= 60 ) and ( not m_contentIntSet.contains( value ) );
@@ -517,14 +537,14 @@ bool Parameter::readParameter( const QString s )
         return true;
     }
 
-    if( paramName.compare( "BYMINUTE", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_BYMINUTE )
     {
         m_content = argument;
         m_type = RR_BYMINUTE;
         bool ret = true;
         bool ok = false;
         int value;
-        for( const QString s : m_content.split( ',', QString::SkipEmptyParts ) )
+        for( const QString &s : m_content.split( ',', QString::SkipEmptyParts ) )
         {
             value = s.toInt( &ok );
             ret = ok and ( value >= 0 ) and ( value < 60 ) and ( not m_contentIntSet.contains( value ) );
@@ -539,14 +559,14 @@ bool Parameter::readParameter( const QString s )
         return true;
     }
 
-    if( paramName.compare( "BYHOUR", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_BYHOUR )
     {
         m_content = argument;
         m_type = RR_BYHOUR;
         bool ret = true;
         bool ok = false;
         int value;
-        for( const QString s : m_content.split( ',', QString::SkipEmptyParts ) )
+        for( const QString &s : m_content.split( ',', QString::SkipEmptyParts ) )
         {
             value = s.toInt( &ok );
             ret = ok and ( value >= 0 ) and ( value < 24 ) and ( not m_contentIntSet.contains( value ) );
@@ -561,14 +581,14 @@ bool Parameter::readParameter( const QString s )
         return true;
     }
 
-    if( paramName.compare( "BYDAY", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_BYDAY )
     {
         m_content = argument.toUpper();
         m_type = RR_BYDAY;
         QStringList list = m_content.split( ',', QString::SkipEmptyParts, Qt::CaseInsensitive );
         QRegularExpression re( "([+-]?\\d*)(\\D*)" );
         IcalWeekDayType weekDay = IcalWeekDayType::WD_NO_DAY;
-        for( const QString elem : list )
+        for( const QString &elem : list )
         {
             QRegularExpressionMatch match = re.match( elem );
             QString vString = match.captured( 1 );
@@ -608,14 +628,14 @@ bool Parameter::readParameter( const QString s )
         return true;
     }
 
-    if( paramName.compare( "BYMONTHDAY", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_BYMONTHDAY )
     {
         m_content = argument;
         m_type = RR_BYMONTHDAY;
         bool ret = true;
         bool ok = false;
         int value;
-        for( const QString s : m_content.split( ',', QString::SkipEmptyParts ) )
+        for( const QString &s : m_content.split( ',', QString::SkipEmptyParts ) )
         {
             value = s.toInt( &ok );
             ret = ok and ( ( value > 0 and value < 32 ) or ( value < 0 and value > -32 ) ) and ( not m_contentIntSet.contains( value ) );
@@ -630,14 +650,14 @@ bool Parameter::readParameter( const QString s )
         return true;
     }
 
-    if( paramName.compare( "BYYEARDAY", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_BYYEARDAY )
     {
         m_content = argument;
         m_type = RR_BYYEARDAY;
         bool ret = true;
         bool ok = false;
         int value;
-        for( const QString s : m_content.split( ',', QString::SkipEmptyParts ) )
+        for( const QString &s : m_content.split( ',', QString::SkipEmptyParts ) )
         {
             value = s.toInt( &ok );
             ret = ok and ( ( value > 0 and value <= 366 ) or ( value < 0 and value >= -366 ) ) and ( not m_contentIntSet.contains( value ) );
@@ -652,14 +672,14 @@ bool Parameter::readParameter( const QString s )
         return true;
     }
 
-    if( paramName.compare( "BYWEEKNO", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_BYWEEKNO )
     {
         m_content = argument;
         m_type = RR_BYWEEKNO;
         bool ret = true;
         bool ok = false;
         int value;
-        for( const QString s : m_content.split( ',', QString::SkipEmptyParts ) )
+        for( const QString &s : m_content.split( ',', QString::SkipEmptyParts ) )
         {
             value = s.toInt( &ok );
             ret = ok and ( ( value > 0 and value <= 53 ) or ( value < 0 and value >= -53 ) ) and ( not m_contentIntSet.contains( value ) );
@@ -674,14 +694,14 @@ bool Parameter::readParameter( const QString s )
         return true;
     }
 
-    if( paramName.compare( "BYMONTH", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_BYMONTH )
     {
         m_content = argument;
         m_type = RR_BYMONTH;
         bool ret = true;
         bool ok = false;
         int value;
-        for( const QString s : m_content.split( ',', QString::SkipEmptyParts ) )
+        for( const QString &s : m_content.split( ',', QString::SkipEmptyParts ) )
         {
             value = s.toInt( &ok );
             ret = ok and value > 0 and value <= 12 and ( not m_contentIntSet.contains( value ) );
@@ -696,14 +716,14 @@ bool Parameter::readParameter( const QString s )
         return true;
     }
 
-    if( paramName.compare( "BYSETPOS", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_BYSETPOS )
     {
         m_content = argument;
         m_type = RR_BYSETPOS;
         bool ret = true;
         bool ok = false;
         int value;
-        for( const QString s : m_content.split( ',', QString::SkipEmptyParts ) )
+        for( const QString &s : m_content.split( ',', QString::SkipEmptyParts ) )
         {
             value = s.toInt( &ok );
             ret = ok and ( ( value > 0 and value <= 366 ) or ( value < 0 and value >= -366 ) ) and ( not m_contentIntSet.contains( value ) );
@@ -718,7 +738,7 @@ bool Parameter::readParameter( const QString s )
         return true;
     }
 
-    if( paramName.compare( "WKST", Qt::CaseInsensitive ) == 0 )
+    if( nameType == RR_WKST )
     {
         m_content = argument.toUpper();
         m_type = RR_WKST;
@@ -16,6 +16,7 @@
 */
 
 #include "property.h"
+#include "icalnames.h"
 
 #include <QRegularExpression>
 #include <QDebug>
@@ -57,6 +58,7 @@ bool Duration::readDuration( QString inDurationText )
     QStringList list = tmp.split( 'T' );
     if( list.count() == 0 )
         return false;
+    bool haveElement = false;   // "PT0S" is a valid duration of zero
 
     if( list.at( 0 ).contains( 'W' ) )
     {
@@ -80,6 +82,7 @@ bool Duration::readDuration( QString inDurationText )
         m_days = vString.toInt( &ok );
         if( not (ok and m_days >= 0 ) )
             return false;
+        haveElement = true;
     }
 
     if( list.count() == 2 ) // time follow-up?
@@ -93,6 +96,7 @@ bool Duration::readDuration( QString inDurationText )
             m_hours = vString.toInt( &ok );
             if( not (ok and m_hours >= 0 ) )
                 return false;
+            haveElement = true;
         }
         if( list.at( 1 ).contains( 'M' ) )
         {
@@ -103,6 +107,7 @@ bool Duration::readDuration( QString inDurationText )
             m_minutes = vString.toInt( &ok );
             if( not (ok and m_minutes >= 0 ) )
                 return false;
+            haveElement = true;
         }
         if( list.at( 1 ).contains( 'S' ) )
         {
@@ -113,11 +118,11 @@ bool Duration::readDuration( QString inDurationText )
             m_seconds = vString.toInt( &ok );
             if( not (ok and m_seconds >= 0 ) )
                 return false;
+            haveElement = true;
         }
     }
 
-    // something must be > 0:
-    return m_weeks > 0 or m_days > 0 or m_hours > 0 or m_minutes > 0 or m_seconds > 0;
+    return haveElement;
 }
 
 
@@ -176,13 +181,13 @@ QString Property::contentToString() const
         break;
         case PST_STRINGLIST:
         {
-            for(const QString v : m_contentStringList )
+            for(const QString &v : m_contentStringList )
                 s = s.append( v ).append( ',' );
         }
         break;
         case PST_DATETIMEVECTOR:
         {
-            for( const DateTime dt : m_contentDateTimeVector )
+            for( const DateTime &dt : m_contentDateTimeVector )
                 s = s.append( dt.toString() ).append( ',' );
         }
         break;
@@ -191,7 +196,7 @@ QString Property::contentToString() const
         break;
         case PST_INTERVALVECTOR:
         {
-            for( const Interval interval : m_contentIntervalVector )
+            for( const Interval &interval : m_contentIntervalVector )
             {
                 if( interval.m_hasDuration )
                     s = s.append( interval.m_start.toString() )
@@ -219,7 +224,7 @@ QString Property::contentToString() const
 
     if( m_parameters.isEmpty() )
         return s.append( "[no param])\n");
-    for( Parameter p : m_parameters )
+    for( const Parameter &p : m_parameters )
     {
         QString description( "{" );
         description = description.append( p.contentToString() ).append("}");
@@ -242,7 +247,7 @@ bool Property::readProperty( const QString inProp )
         return false;
 
     // fill the parameters
-    for( QString ps : parameterList )
+    for( const QString &ps : parameterList )
     {
         Parameter p = Parameter();
         if( not p.readParameter( ps ) )
@@ -250,7 +255,7 @@ bool Property::readProperty( const QString inProp )
             m_hasErrors = true;
             return false;
         }
-        m_parameters.append( p );
+        m_parameters.append( std::move( p ) );
     }
 
     // now, that we have our parameters, store the
@@ -325,7 +330,7 @@ bool Property::readProperty( const QString inProp )
         {
             // a list
             QStringList list = propertyArgument.split( ',', QString::SkipEmptyParts );
-            for( QString s : list )
+            for( const QString &s : list )
             {
                 DateTime dt;
                 if( dt.readDateTime( s ) )
@@ -357,7 +362,7 @@ bool Property::readProperty( const QString inProp )
         {
             // a list
             QStringList list = propertyArgument.split( ',', QString::SkipEmptyParts );
-            for( QString s : list )
+            for( const QString &s : list )
             {
                 m_contentStringList.append( s.trimmed() );
             }
@@ -433,7 +438,7 @@ bool Property::readProperty( const QString inProp )
         bool validateOnlyInterval = false;
         bool validateOnlyElementOrList = false;
 
-        for( QString elem : list )
+        for( const QString &elem : list )
         {
             if( propertyArgument.contains( '/' ) )  // interval?
             {
@@ -569,6 +574,14 @@ bool Property::readProperty( const QString inProp )
         return true;
     }
 
+    if( m_type == PT_SUMMARY or m_type == PT_DESCRIPTION or
+        m_type == PT_LOCATION or m_type == PT_COMMENT )
+    {
+        m_content = unescapeText( propertyArgument );
+        m_storageType = Property::PST_STRING;
+        return true;
+    }
+
     // everything else is just storen in a string
     m_storageType = Property::PST_STRING;
     m_content = propertyArgument;    // always store a string
@@ -580,7 +593,7 @@ bool Property::getParameterByType(const Parameter::IcalParameterType inSearchTyp
                                    Parameter& outParam ) const
 {
     if( m_parameters.empty() ) return false;
-    for( Parameter param : m_parameters )
+    for( const Parameter &param : m_parameters )
         if( param.m_type == inSearchType )
         {
             outParam = param;
@@ -605,7 +618,7 @@ bool Property::validate()
     if( m_type == PT_RRULE )
     {
         bool ret = true;
-        for( const Parameter param : m_parameters )
+        for( const Parameter &param : m_parameters )
             ret = ret and param.validate();
         return ret;
     }
@@ -615,107 +628,54 @@ bool Property::validate()
 
 QString Property::propertyType( const IcalPropertyType inIpt ) const
 {
-    if( inIpt == PT_ACTION )            return QString( "ACTION" );
-    if( inIpt == PT_ATTACH )            return QString( "ATTACH" );
-    if( inIpt == PT_ATTENDEE )          return QString( "ATTENDEE" );
-    if( inIpt == PT_CALSCALE )          return QString( "CALSCALE" );
-    if( inIpt == PT_CATEGORIES )        return QString( "CATEGORIES" );
-    if( inIpt == PT_CLASS )             return QString( "CLASS" );
-    if( inIpt == PT_COMMENT )           return QString( "COMMENT" );
-    if( inIpt == PT_COMPLETED )         return QString( "COMPLETED" );
-    if( inIpt == PT_CONTACT )           return QString( "CONTACT" );
-    if( inIpt == PT_CREATED )           return QString( "CREATED" );
-    if( inIpt == PT_DESCRIPTION )       return QString( "DESCRIPTION" );
-    if( inIpt == PT_DTEND )             return QString( "DTEND" );
-    if( inIpt == PT_DTSTAMP )           return QString( "DTSTAMP" );
-    if( inIpt == PT_DTSTART )           return QString( "DTSTART" );
-    if( inIpt == PT_DUE )               return QString( "DUE" );
-    if( inIpt == PT_DURATION )          return QString( "DURATION" );
-    if( inIpt == PT_EXDATE )            return QString( "EXDATE" );
-    if( inIpt == PT_FREEBUSY )          return QString( "FREEBUSY" );
-    if( inIpt == PT_GEO )               return QString( "GEO" );
-    if( inIpt == PT_LAST_MODIFIED )     return QString( "LAST-MODIFIED" );
-    if( inIpt == PT_LOCATION )          return QString( "LOCATION" );
-    if( inIpt == PT_METHOD )            return QString( "METHOD" );
-    if( inIpt == PT_ORGANIZER )         return QString( "ORGANIZER" );
-    if( inIpt == PT_PERCENT_COMPLETE )  return QString( "PERCENT-COMPLETE" );
-    if( inIpt == PT_PRIORITY )          return QString( "PRIORITY" );
-    if( inIpt == PT_PRODID )            return QString( "PRODID" );
-    if( inIpt == PT_RDATE )             return QString( "RDATE" );
-    if( inIpt == PT_RECURRENCE_ID )     return QString( "RECURRENCE-ID" );
-    if( inIpt == PT_RELATED_TO )        return QString( "RELATED-TO" );
-    if( inIpt == PT_REPEAT )            return QString( "REPEAT" );
-    if( inIpt == PT_REQUEST_STATUS )    return QString( "REQUEST-STATUS" );
-    if( inIpt == PT_RESOURCES )         return QString( "RESOURCES" );
-    if( inIpt == PT_RRULE )             return QString( "RRULE" );
-    if( inIpt == PT_SEQUENCE )          return QString( "SEQUENCE" );
-    if( inIpt == PT_STATUS )            return QString( "STATUS" );
-    if( inIpt == PT_SUMMARY )           return QString( "SUMMARY" );
-    if( inIpt == PT_TRANSP )            return QString( "TRANSP" );
-    if( inIpt == PT_TRIGGER )           return QString( "TRIGGER" );
-    if( inIpt == PT_TZID )              return QString( "TZID" );
-    if( inIpt == PT_TZNAME )            return QString( "TZNAME" );
-    if( inIpt == PT_TZOFFSETFROM )      return QString( "TZOFFSETFROM" );
-    if( inIpt == PT_TZOFFSETTO )        return QString( "TZOFFSETTO" );
-    if( inIpt == PT_TZURL )             return QString( "TZURL" );
-    if( inIpt == PT_UID )               return QString( "UID" );
-    if( inIpt == PT_URL )               return QString( "URL" );
-    if( inIpt == PT_VERSION )           return QString( "VERSION" );
-    // if( inIpt == PT_PROPERTY_UNKNOWN )
-    return QString( "PROPERTY_UNKNOWN" );
+    const char* name = IcalNames::propertyName( inIpt );
+    if( name == nullptr )
+        return QString( "PROPERTY_UNKNOWN" );
+    return QString( name );
 }
 
 
 Property::IcalPropertyType Property::propertyType( const QString inIptString ) const
 {
-    if( inIptString == "ACTION" )           return PT_ACTION;
-    if( inIptString == "ATTACH" )           return PT_ATTACH;
-    if( inIptString == "ATTENDEE" )         return PT_ATTENDEE;
-    if( inIptString == "CALSCALE" )         return PT_CALSCALE;
-    if( inIptString == "CATEGORIES" )       return PT_CATEGORIES;
-    if( inIptString == "CLASS" )            return PT_CLASS;
-    if( inIptString == "COMMENT" )          return PT_COMMENT;
-    if( inIptString == "COMPLETED" )        return PT_COMPLETED;
-    if( inIptString == "CONTACT" )          return PT_CONTACT;
-    if( inIptString == "CREATED" )          return PT_CREATED;
-    if( inIptString == "DESCRIPTION" )      return PT_DESCRIPTION;
-    if( inIptString == "DTEND" )            return PT_DTEND;
-    if( inIptString == "DTSTAMP" )          return PT_DTSTAMP;
-    if( inIptString == "DTSTART" )          return PT_DTSTART;
-    if( inIptString == "DUE" )              return PT_DUE;
-    if( inIptString == "DURATION" )         return PT_DURATION;
-    if( inIptString == "EXDATE" )           return PT_EXDATE;
-    if( inIptString == "FREEBUSY" )         return PT_FREEBUSY;
-    if( inIptString == "GEO" )              return PT_GEO;
-    if( inIptString == "LAST-MODIFIED" )    return PT_LAST_MODIFIED;
-    if( inIptString == "LOCATION" )         return PT_LOCATION;
-    if( inIptString == "METHOD" )           return PT_METHOD;
-    if( inIptString == "ORGANIZER" )        return PT_ORGANIZER;
-    if( inIptString == "PERCENT-COMPLETE" ) return PT_PERCENT_COMPLETE;
-    if( inIptString == "PRIORITY" )         return PT_PRIORITY;
-    if( inIptString == "PRODID" )           return PT_PRODID;
-    if( inIptString == "RDATE" )            return PT_RDATE;
-    if( inIptString == "RECURRENCE-ID" )    return PT_RECURRENCE_ID;
-    if( inIptString == "RELATED-TO" )       return PT_RELATED_TO;
-    if( inIptString == "REPEAT" )           return PT_REPEAT;
-    if( inIptString == "REQUEST-STATUS" )   return PT_REQUEST_STATUS;
-    if( inIptString == "RESOURCES" )        return PT_RESOURCES;
-    if( inIptString == "RRULE" )            return PT_RRULE;
-    if( inIptString == "SEQUENCE" )         return PT_SEQUENCE;
-    if( inIptString == "STATUS" )           return PT_STATUS;
-    if( inIptString == "SUMMARY" )          return PT_SUMMARY;
-    if( inIptString == "TRANSP" )           return PT_TRANSP;
-    if( inIptString == "TRIGGER" )          return PT_TRIGGER;
-    if( inIptString == "TZID" )             return PT_TZID;
-    if( inIptString == "TZNAME" )           return PT_TZNAME;
-    if( inIptString == "TZOFFSETFROM" )     return PT_TZOFFSETFROM;
-    if( inIptString == "TZOFFSETTO" )       return PT_TZOFFSETTO;
-    if( inIptString == "TZURL" )            return PT_TZURL;
-    if( inIptString == "UID" )              return PT_UID;
-    if( inIptString == "URL" )              return PT_URL;
-    if( inIptString == "VERSION" )          return PT_VERSION;
-    // if( inIptString == "PROPERTY_UNKNOWN" )
-    return PT_PROPERTY_UNKNOWN;
+    return IcalNames::propertyType( inIptString );
+}
+
+
+QString Property::escapeText( const QString &inText )
+{
+    QString out;
+    out.reserve( inText.size() + 8 );
+    for( const QChar c : inText )
+    {
+        if( c == '\\' or c == ';' or c == ',' )
+            out.append( '\\' ).append( c );
+        else if( c == '\n' )
+            out.append( "\\n" );
+        else if( c != '\r' )
+            out.append( c );
+    }
+    return out;
+}
+
+
+QString Property::unescapeText( const QString &inText )
+{
+    if( not inText.contains( '\\' ) )
+        return inText;
+    QString out;
+    out.reserve( inText.size() );
+    for( int i = 0; i < inText.size(); i++ )
+    {
+        QChar c = inText.at( i );
+        if( c == '\\' and i + 1 < inText.size() )
+        {
+            c = inText.at( ++i );
+            if( c == 'n' or c == 'N' )
+                c = '\n';
+        }
+        out.append( c );
+    }
+    return out;
 }
 
 
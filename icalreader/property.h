@@ -153,6 +153,10 @@ struct Property
     static void         splitParts( const QString inToSplit, QString &outPropName,
                                     QString &outArgument, QStringList &outParameters );
 
+    // TEXT values (RFC 5545, 3.3.11): backslash, ';', ',' and newlines are escaped in files
+    static QString      escapeText( const QString &inText );
+    static QString      unescapeText( const QString &inText );
+
     // === Data ===
 
     // holds the text
@@ -26,7 +26,7 @@ StandardDaylightComponent::StandardDaylightComponent()
 QString StandardDaylightComponent::contentToString() const
 {
     QString s( "{StdDay:" );
-    for( const Property p : m_properties )
+    for( const Property &p : m_properties )
         s = s.append( p.contentToString() );
     return s.append( "}\n" );
 }
@@ -36,7 +36,7 @@ void StandardDaylightComponent::readContentLine( const QString inContent )
 {
     Property p = Property();
     if( p.readProperty( inContent ) )
-        m_properties.append( p );
+        m_properties.append( std::move( p ) );
 }
 
 
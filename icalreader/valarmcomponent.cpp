@@ -28,7 +28,7 @@ VAlarmComponent::VAlarmComponent()
 QString VAlarmComponent::contentToString() const
 {
     QString s("{Alarm:");
-    for( const Property p : m_properties )
+    for( const Property &p : m_properties )
         s = s.append( p.contentToString() );
     return s.append( "}\n" );
 }
@@ -40,7 +40,7 @@ void VAlarmComponent::readContentLine( const QString inContent )
     // so just push parameters
     Property p = Property();
     if( p.readProperty( inContent ) )
-        m_properties.append( p );
+        m_properties.append( std::move( p ) );
 }
 
 
@@ -48,7 +48,7 @@ bool VAlarmComponent::validate()
 {
     int count_action = 0;       // MUST 1
     int count_trigger = 0;      // Must 1
-    for( Property prop : m_properties )
+    for( Property &prop : m_properties )
     {
         if( not prop.validate() )
             return false;
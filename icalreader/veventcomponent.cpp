@@ -31,9 +31,9 @@ VEventComponent::VEventComponent()
 QString VEventComponent::contentToString() const
 {
     QString s( "{VEVENT:" );
-    for( const Property p : m_properties )
+    for( const Property &p : m_properties )
         s = s.append( p.contentToString() );
-    for( const VAlarmComponent c : m_vAlarmComponents )
+    for( const VAlarmComponent &c : m_vAlarmComponents )
         s = s.append( c.contentToString() );
     return s.append( "}\n" );
 }
@@ -45,7 +45,7 @@ void VEventComponent::readContentLine( const QString inContent )
     {
         m_activeComponent = IN_VALARM;
         VAlarmComponent component = VAlarmComponent();
-        m_vAlarmComponents.append( component );
+        m_vAlarmComponents.append( std::move( component ) );
         return;
     }
     if( inContent.startsWith( "END:VALARM", Qt::CaseInsensitive ) )
@@ -61,9 +61,9 @@ void VEventComponent::readContentLine( const QString inContent )
         {
             // Put DT-START first, this makes it easier to test for DT_END or DURATION
             if( p.m_type == Property::PT_DTSTART )
-                m_properties.prepend( p );
+                m_properties.prepend( std::move( p ) );
             else
-                m_properties.append( p );
+                m_properties.append( std::move( p ) );
         }
     }
     else
@@ -104,7 +104,7 @@ bool VEventComponent::validate()
         if( prop.m_type == Property::PT_RRULE )
         {
             int count_and_until = 0;        // MUST 0 or 1
-            for( const Parameter param : prop.m_parameters )
+            for( const Parameter &param : prop.m_parameters )
             {
                 if( param.m_type == Parameter::RR_COUNT or param.m_type == Parameter::RR_UNTIL )
                     count_and_until++;
@@ -123,7 +123,7 @@ bool VEventComponent::validate()
         u = u.append( QDateTime::currentDateTime().toString( "yyyyMMddhhmmss" ) );
         if( p.readProperty( u ) )
         {
-            m_properties.append( p );
+            m_properties.append( std::move( p ) );
             count_uid++;
             qDebug() << " * Append UID" << u ;
         }
@@ -135,14 +135,14 @@ bool VEventComponent::validate()
         s = s.append( QDateTime::currentDateTime().toString( "yyyyMMddThhmmssZ" ) );
         if( p.readProperty( s ) )
         {
-            m_properties.append( p );
+            m_properties.append( std::move( p ) );
             count_dtstamp++;
             qDebug() << " * Append DTSTAMP" << s ;
         }
     }
 
     bool alarm_ok = true;
-    for( VAlarmComponent va : m_vAlarmComponents )
+    for( VAlarmComponent &va : m_vAlarmComponents )
         alarm_ok = alarm_ok and va.validate();
     if( not alarm_ok )
         qDebug() << " * Alarm not ok.";
@@ -26,7 +26,7 @@ VJournalComponent::VJournalComponent()
 QString VJournalComponent::contentToString() const
 {
     QString s( "{VJournal:" );
-    for( const Property p : m_properties )
+    for( const Property &p : m_properties )
         s = s.append( p.contentToString() );
     return s.append( "}\n" );
 }
@@ -36,7 +36,7 @@ void VJournalComponent::readContentLine( const QString inContent )
 {
     Property p = Property();
     if( p.readProperty( inContent ) )
-        m_properties.append( p );
+        m_properties.append( std::move( p ) );
 }
 
 
@@ -44,7 +44,7 @@ bool VJournalComponent::validate()
 {
     int count_uid = 0;          // MUST exact 1
     int count_dtstamp = 0;      // Must exact 1
-    for( const Property prop : m_properties )
+    for( const Property &prop : m_properties )
     {
         if( prop.m_type == Property::PT_UID )
             count_uid++;
@@ -29,11 +29,11 @@ VTimezoneComponent::VTimezoneComponent()
 QString VTimezoneComponent::contentToString() const
 {
     QString s( "{VTimezone:" );
-    for( const Property p : m_properties )
+    for( const Property &p : m_properties )
         s = s.append( p.contentToString() );
-    for( const StandardDaylightComponent sc : m_StandardComponents )
+    for( const StandardDaylightComponent &sc : m_StandardComponents )
         s = s.append( sc.contentToString() );
-    for( const StandardDaylightComponent dc : m_DaylightComponents )
+    for( const StandardDaylightComponent &dc : m_DaylightComponents )
         s = s.append( dc.contentToString() );
     return s.append( "}\n" );
 }
@@ -45,7 +45,7 @@ void VTimezoneComponent::readContentLine( const QString inContent )
     {
         m_activeComponent = IN_STANDARD;
         StandardDaylightComponent component = StandardDaylightComponent();
-        m_StandardComponents.append( component );
+        m_StandardComponents.append( std::move( component ) );
         return;
     }
 
@@ -53,7 +53,7 @@ void VTimezoneComponent::readContentLine( const QString inContent )
     {
         m_activeComponent = IN_DAYLIGHT;
         StandardDaylightComponent component = StandardDaylightComponent();
-        m_DaylightComponents.append( component );
+        m_DaylightComponents.append( std::move( component ) );
         return;
     }
 
@@ -68,7 +68,7 @@ void VTimezoneComponent::readContentLine( const QString inContent )
     {
         Property p = Property();
         if( p.readProperty( inContent ) )
-            m_properties.append( p );
+            m_properties.append( std::move( p ) );
         return;
     }
 
@@ -86,7 +86,7 @@ void VTimezoneComponent::readContentLine( const QString inContent )
 bool VTimezoneComponent::validate()
 {
     int count_tzid = 0;     // MUST 1
-    for( const Property prop : m_properties )
+    for( const Property &prop : m_properties )
     {
         if( prop.m_type == Property::PT_TZID )
             count_tzid++;
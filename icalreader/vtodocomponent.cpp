@@ -29,9 +29,9 @@ VTodoComponent::VTodoComponent()
 QString VTodoComponent::contentToString() const
 {
     QString s( "{VTODO:" );
-    for( const Property p : m_properties )
+    for( const Property &p : m_properties )
         s = s.append( p.contentToString() );
-    for( const VAlarmComponent c : m_vAlarmComponents )
+    for( const VAlarmComponent &c : m_vAlarmComponents )
         s = s.append( c.contentToString() );
     return s.append( "}\n" );
 }
@@ -43,7 +43,7 @@ void VTodoComponent::readContentLine( const QString inContent )
     {
         m_activeComponent = IN_VALARM;
         VAlarmComponent component = VAlarmComponent();
-        m_vAlarmComponents.append( component );
+        m_vAlarmComponents.append( std::move( component ) );
         return;
     }
     if( inContent.startsWith( "END:VALARM", Qt::CaseInsensitive ) )
@@ -56,7 +56,7 @@ void VTodoComponent::readContentLine( const QString inContent )
     {
         Property p = Property();
         if( p.readProperty( inContent ) )
-            m_properties.append( p );
+            m_properties.append( std::move( p ) );
     }
     else
         m_vAlarmComponents.last().readContentLine( inContent );
@@ -67,7 +67,7 @@ bool VTodoComponent::validate()
 {
     int count_uid = 0;          // MUST exact 1
     int count_dtstamp = 0;      // Must exact 1
-    for( const Property prop : m_properties )
+    for( const Property &prop : m_properties )
     {
         if( prop.m_type == Property::PT_UID )
             count_uid++;
@@ -0,0 +1,73 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "allocationcounter.h"
+
+#include <atomic>
+#include <cstdlib>
+
+
+#if defined( __GLIBC__ )
+
+static std::atomic<qint64> s_allocations( 0 );
+
+
+/* The executable defines malloc() and friends itself, so every shared library calls these.
+ *  They count and hand over to the allocator of glibc. */
+extern "C"
+{
+void* __libc_malloc( size_t inSize );
+void* __libc_calloc( size_t inCount, size_t inSize );
+void* __libc_realloc( void* inPtr, size_t inSize );
+
+
+void* malloc( size_t inSize ) __THROW
+{
+    s_allocations.fetch_add( 1, std::memory_order_relaxed );
+    return __libc_malloc( inSize );
+}
+
+
+void* calloc( size_t inCount, size_t inSize ) __THROW
+{
+    s_allocations.fetch_add( 1, std::memory_order_relaxed );
+    return __libc_calloc( inCount, inSize );
+}
+
+
+void* realloc( void* inPtr, size_t inSize ) __THROW
+{
+    // growing a block is no new allocation
+    if( not inPtr )
+        s_allocations.fetch_add( 1, std::memory_order_relaxed );
+    return __libc_realloc( inPtr, inSize );
+}
+}
+
+
+qint64 allocationCount()
+{
+    return s_allocations.load( std::memory_order_relaxed );
+}
+
+#else
+
+qint64 allocationCount()
+{
+    return -1;
+}
+
+#endif
@@ -0,0 +1,28 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+
+/* heap allocations of this process so far, -1 if they are not counted on this platform.
+ *  Counted are malloc(), calloc() and realloc() of a null pointer, Qt containers and
+ *  operator new both allocate with these. Only glibc is supported. */
+qint64 allocationCount();
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,229 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "importbenchmark.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QTextStream>
+#include <QThread>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include "allocationcounter.h"
+#include "appointmentqueue.h"
+#include "icalwriter.h"
+#include "importscheduler.h"
+#include "importstoragethread.h"
+#include "storage.h"
+
+
+// appointments taken out of the queue at once in parse only mode
+static const int DRAIN_BATCH_SIZE = 64;
+
+
+static void countAndDelete( Appointment* app, ImportCounts &counts )
+{
+    counts.m_appointments++;
+    if( app->isStreamed() )
+        counts.m_streamed++;
+    counts.m_events += app->m_eventVector.count();
+    delete app;
+}
+
+
+/* Last stage in parse only mode: empties the queue like ImportStorageThread,
+ *  but drops the appointments instead of storing them. */
+class QueueDrainThread : public QThread
+{
+public:
+    QueueDrainThread( AppointmentQueue* inQueue, ImportCounts &inCounts )
+        : m_queue( inQueue ), m_counts( inCounts ) {}
+
+    void run() override
+    {
+        QVector<Appointment*> batch;
+        while( m_queue->popBatch( batch, DRAIN_BATCH_SIZE ) > 0 )
+        {
+            for( Appointment* app : batch )
+                countAndDelete( app, m_counts );
+        }
+    }
+
+private:
+    AppointmentQueue*   m_queue;
+    ImportCounts        &m_counts;
+};
+
+
+ImportBenchmark::ImportBenchmark( const QString &inDatabaseName, const bool inParseOnly,
+                                  const bool inForce, QObject* parent )
+    :
+      QObject( parent ),
+      m_databaseName( inDatabaseName ),
+      m_parseOnly( inParseOnly ),
+      m_force( inForce ),
+      m_maxThreads( 0 )
+{
+    m_counts.m_appointments = 0;
+    m_counts.m_streamed = 0;
+    m_counts.m_events = 0;
+}
+
+
+void ImportBenchmark::setMaxThreads( const int inMaxThreads )
+{
+    m_maxThreads = inMaxThreads;
+}
+
+
+int ImportBenchmark::run( const QStringList &inFilenames )
+{
+    QTextStream out( stdout );
+    int exitCode = 0;
+    Storage* storage = m_parseOnly ? nullptr : new Storage( QString(), m_databaseName );
+
+    // === read, parse and store, the stages run in parallel ===
+    const qint64 firstAllocation = allocationCount();
+    QElapsedTimer timer;
+    timer.start();
+    AppointmentQueue queue;
+    QThread* lastStage;
+    if( storage )
+    {
+        ImportStorageThread* storageThread = new ImportStorageThread( &queue, m_databaseName, this );
+        // direct connection: count in the storage thread, the appointments are of no use here
+        connect( storageThread, SIGNAL(sigAppointmentStored(Appointment*)),
+                 this, SLOT(slotAppointmentStored(Appointment*)), Qt::DirectConnection );
+        lastStage = storageThread;
+    }
+    else
+        lastStage = new QueueDrainThread( &queue, m_counts );
+    lastStage->start();
+
+    ImportScheduler scheduler( &queue );
+    if( m_maxThreads > 0 )
+        scheduler.setMaxThreads( m_maxThreads );
+    // the scheduler hears from its threads by queued signals
+    QEventLoop loop;
+    connect( &scheduler, SIGNAL(sigAllFinished()), &loop, SLOT(quit()) );
+    scheduler.start( inFilenames, m_force ? nullptr : storage );
+    if( scheduler.isRunning() )
+        loop.exec();
+    const qint64 parseMSecs = timer.elapsed();
+
+    queue.close();
+    lastStage->wait();
+    const qint64 storeMSecs = timer.elapsed();
+    const qint64 numAllocations = allocationCount() - firstAllocation;
+    delete lastStage;
+
+    // remember the files for the next import, like IcalImportDialog does
+    int numParsed = 0;
+    int numAppointments = 0;
+    int numSkippedVEvents = 0;
+    for( const ImportScheduler::ImportJob &job : scheduler.jobs() )
+    {
+        numAppointments += job.m_numAppointments;
+        numSkippedVEvents += job.m_numSkippedVEvents;
+        if( job.m_state == ImportScheduler::JS_FAILED )
+        {
+            out << "ERR: " << job.m_filename << ( static_cast<IcalImportThread::IcalDislikeReasonType>(job.m_dislikeReason) ==
+                                                IcalImportThread::IcalDislikeReasonType::NOT_READABLE ?
+                                                    " is not readable\n" : " does not validate\n" );
+            exitCode = 1;
+        }
+        else if( job.m_state == ImportScheduler::JS_UNCHANGED )
+            out << "OK: " << job.m_filename << " unchanged since last import\n";
+        else if( job.m_state == ImportScheduler::JS_DONE )
+        {
+            numParsed++;
+            if( storage )
+            {
+                storage->setImportHashes( job.m_filename, job.m_fileHash, job.m_vEventHashes );
+                storage->setFreeBusyPeriods( job.m_filename, job.m_freeBusyPeriods );
+            }
+        }
+    }
+    delete storage;
+
+    out << "files:             " << numParsed << " of " << inFilenames.count() << " parsed, "
+        << scheduler.maxThreads() << " threads\n";
+    out << "appointments:      " << numAppointments << " parsed, " << numSkippedVEvents << " VEVENTs unchanged\n";
+    out << ( m_parseOnly ? "dropped:           " : "stored:            " )
+        << m_counts.m_appointments << " appointments, " << m_counts.m_events << " events, "
+        << m_counts.m_streamed << " streamed\n";
+    out << "read and parse:    " << parseMSecs << " ms\n";
+    out << ( m_parseOnly ? "drain done after:  " : "store done after:  " ) << storeMSecs << " ms\n";
+    if( firstAllocation >= 0 )
+        out << "allocations:       " << numAllocations << "\n";
+    out << "peak RSS:          " << peakRssKiB() << " KiB\n";
+    return exitCode;
+}
+
+
+int ImportBenchmark::exportTo( const QString &inFilename )
+{
+    QTextStream out( stdout );
+    QFile file( inFilename );
+    if( not file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        out << "ERR: cannot write " << inFilename << "\n";
+        return 1;
+    }
+    Storage storage( QString(), m_databaseName );
+    QElapsedTimer timer;
+    timer.start();
+    IcalWriter writer( &file );
+    int numAppointments = writer.writeStorage( &storage );
+    file.close();
+    if( numAppointments < 0 )
+    {
+        out << "ERR: cannot write " << inFilename << "\n";
+        return 1;
+    }
+    out << "exported:          " << numAppointments << " appointments, " << file.size() << " bytes\n";
+    out << "export:            " << timer.elapsed() << " ms\n";
+    out << "peak RSS:          " << peakRssKiB() << " KiB\n";
+    return 0;
+}
+
+
+long ImportBenchmark::peakRssKiB()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) == 0 )
+    {
+#ifdef Q_OS_MACOS
+        return usage.ru_maxrss / 1024;      // bytes here
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return -1;
+}
+
+
+void ImportBenchmark::slotAppointmentStored( Appointment* app )
+{
+    // we own it now, but nobody wants to see it
+    countAndDelete( app, m_counts );
+}
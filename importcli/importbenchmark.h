@@ -0,0 +1,78 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef IMPORTBENCHMARK_H
+#define IMPORTBENCHMARK_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "appointmentmanager.h"
+
+
+// what reached the last stage of the import
+struct ImportCounts
+{
+    int     m_appointments;
+    int     m_streamed;     // sub-daily recurrences, they have no event list
+    qint64  m_events;
+};
+
+
+/* Drives the ical import (and export) without any gui, so the import can be profiled on machines
+ *  without display. The stages are the same as in IcalImportDialog:
+ *  - read and parse: ImportScheduler runs an IcalImportThread per file, which reads,
+ *           parses, interprets and expands it
+ *  - store: ImportStorageThread writes into the database. In parse only mode, the
+ *           appointments are just counted and dropped instead.
+ * run() blocks until everything is done and prints timings, counts, allocations and the peak memory.
+ */
+class ImportBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    /* inParseOnly: nothing is stored, the database is not even opened.
+     * inForce: import files and VEVENTs, even if they are unchanged since the last import */
+    explicit ImportBenchmark( const QString &inDatabaseName, const bool inParseOnly,
+                              const bool inForce, QObject* parent = Q_NULLPTR );
+
+    // threads for reading and parsing, 0 for the default of ImportScheduler
+    void setMaxThreads( const int inMaxThreads );
+
+    // returns the exit code: 0, if every file was readable and valid
+    int run( const QStringList &inFilenames );
+
+    /* writes the whole database as ical file, prints the time it took.
+     * Returns the exit code. Import, export, import again is the round trip test. */
+    int exportTo( const QString &inFilename );
+
+private:
+    // peak resident set size of this process in KiB, -1 if unknown
+    static long peakRssKiB();
+
+    QString             m_databaseName;
+    bool                m_parseOnly;
+    bool                m_force;
+    int                 m_maxThreads;
+    ImportCounts        m_counts;   // written by the storage thread only
+
+private slots:
+    void slotAppointmentStored( Appointment* app );
+};
+
+#endif // IMPORTBENCHMARK_H
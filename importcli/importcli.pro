@@ -0,0 +1,66 @@
+#-------------------------------------------------
+#
+# Headless ical import, used for profiling the import on machines without display
+#
+#-------------------------------------------------
+
+# usercalendar.h needs widgets, although no widget is ever shown
+QT       += core gui sql widgets
+
+TARGET = importcli
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000
+
+INCLUDEPATH += ../src ../icalreader
+
+SOURCES += main.cpp \
+    allocationcounter.cpp \
+    importbenchmark.cpp \
+    ../src/storage.cpp \
+    ../src/usercalendar.cpp \
+    ../src/datetime.cpp \
+    ../src/appointmentmanager.cpp \
+    ../src/icalimportthread.cpp \
+    ../src/importstoragethread.cpp \
+    ../src/importscheduler.cpp \
+    ../src/appointmentqueue.cpp \
+    ../icalreader/icalbody.cpp \
+    ../icalreader/icalinterpreter.cpp \
+    ../icalreader/icalwriter.cpp \
+    ../icalreader/parameter.cpp \
+    ../icalreader/property.cpp \
+    ../icalreader/standarddaylightcomponent.cpp \
+    ../icalreader/valarmcomponent.cpp \
+    ../icalreader/veventcomponent.cpp \
+    ../icalreader/vfreebusycomponent.cpp \
+    ../icalreader/vjournalcomponent.cpp \
+    ../icalreader/vtimezonecomponent.cpp \
+    ../icalreader/vtodocomponent.cpp
+
+HEADERS  += allocationcounter.h \
+    importbenchmark.h \
+    ../src/storage.h \
+    ../src/usercalendar.h \
+    ../src/datetime.h \
+    ../src/appointmentmanager.h \
+    ../src/icalimportthread.h \
+    ../src/importstoragethread.h \
+    ../src/importscheduler.h \
+    ../src/appointmentqueue.h \
+    ../icalreader/icalbody.h \
+    ../icalreader/icalinterpreter.h \
+    ../icalreader/icalnames.h \
+    ../icalreader/icalwriter.h \
+    ../icalreader/parameter.h \
+    ../icalreader/property.h \
+    ../icalreader/standarddaylightcomponent.h \
+    ../icalreader/valarmcomponent.h \
+    ../icalreader/veventcomponent.h \
+    ../icalreader/vfreebusycomponent.h \
+    ../icalreader/vjournalcomponent.h \
+    ../icalreader/vtimezonecomponent.h \
+    ../icalreader/vtodocomponent.h
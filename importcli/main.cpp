@@ -0,0 +1,64 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include "importbenchmark.h"
+
+
+int main( int argc, char* argv[] )
+{
+    QCoreApplication app( argc, argv );
+    QCoreApplication::setApplicationName( "importcli" );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Imports ical files without gui and prints timings per stage, "
+                                      "counts, allocations and the peak memory. Optionally exports the database." );
+    parser.addHelpOption();
+    QCommandLineOption databaseOption( QStringList() << "d" << "database",
+                                       "SQLITE database to import into.", "file", "daylightdb.sqlite3" );
+    QCommandLineOption parseOnlyOption( QStringList() << "p" << "parse-only",
+                                        "Parse and expand only, store nothing." );
+    QCommandLineOption forceOption( QStringList() << "f" << "force",
+                                    "Import files and VEVENTs, even if unchanged since the last import." );
+    QCommandLineOption exportOption( QStringList() << "e" << "export",
+                                     "Afterwards, write the whole database into an ical file.", "file" );
+    QCommandLineOption threadsOption( QStringList() << "t" << "threads",
+                                      "Read and parse at most n files at once, default: number of cores.", "n" );
+    parser.addOption( databaseOption );
+    parser.addOption( parseOnlyOption );
+    parser.addOption( forceOption );
+    parser.addOption( exportOption );
+    parser.addOption( threadsOption );
+    parser.addPositionalArgument( "files", "ical files to import.", "[files...]" );
+    parser.process( app );
+
+    if( parser.positionalArguments().isEmpty() and not parser.isSet( exportOption ) )
+        parser.showHelp( 1 );
+
+    ImportBenchmark benchmark( parser.value( databaseOption ), parser.isSet( parseOnlyOption ),
+                               parser.isSet( forceOption ) );
+    if( parser.isSet( threadsOption ) )
+        benchmark.setMaxThreads( parser.value( threadsOption ).toInt() );
+    int exitCode = 0;
+    if( not parser.positionalArguments().isEmpty() )
+        exitCode = benchmark.run( parser.positionalArguments() );
+    if( exitCode == 0 and parser.isSet( exportOption ) )
+        exitCode = benchmark.exportTo( parser.value( exportOption ) );
+    return exitCode;
+}
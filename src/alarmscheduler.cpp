@@ -0,0 +1,146 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "alarmscheduler.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <QDateTime>
+
+
+AlarmScheduler::AlarmScheduler( QObject* parent )
+    :
+      QObject( parent ),
+      m_windowEndSecs( 0 )
+{
+    m_timer = new QTimer( this );
+    m_timer->setSingleShot( true );
+    // alarms are up to a day ahead, a coarse timer would be minutes late
+    m_timer->setTimerType( Qt::PreciseTimer );
+    connect( m_timer, SIGNAL(timeout()), this, SLOT(slotTimeout()) );
+}
+
+
+AlarmScheduler::~AlarmScheduler()
+{
+    qDeleteAll( m_appointments );
+}
+
+
+void AlarmScheduler::setAppointments( const QVector<Appointment*> &inAppointments )
+{
+    qDeleteAll( m_appointments );
+    m_appointments = inAppointments;
+    m_heap.clear();
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    m_windowEndSecs = now + ALARM_WINDOW_SECS;
+    fillWindow( now, m_windowEndSecs );
+    rearm();
+}
+
+
+bool AlarmScheduler::isLater( const Trigger &inA, const Trigger &inB )
+{
+    return inA.m_triggerSecs > inB.m_triggerSecs;
+}
+
+
+void AlarmScheduler::fillWindow( const qint64 inFirstSecs, const qint64 inEndSecs )
+{
+    for( int i = 0; i < m_appointments.count(); i++ )
+        addTriggers( i, inFirstSecs, inEndSecs );
+}
+
+
+/* every trigger of the appointment within inFirstSecs ... inEndSecs (excluding) goes to the heap */
+void AlarmScheduler::addTriggers( const int inAppointmentIndex, const qint64 inFirstSecs, const qint64 inEndSecs )
+{
+    const Appointment* app = m_appointments.at( inAppointmentIndex );
+
+    // all alarms and repetitions are offsets to the start of an occurrence
+    QVector<qint64> offsets;
+    for( const AppointmentAlarm* alarm : app->m_appAlarms )
+    {
+        for( int repeat = 0; repeat <= alarm->m_repeatNumber; repeat++ )
+            offsets.append( alarm->m_alarmSecs + repeat * static_cast<qint64>( alarm->m_pauseSecs ) );
+    }
+    if( offsets.isEmpty() )
+        return;
+    const qint64 minOffset = *std::min_element( offsets.constBegin(), offsets.constEnd() );
+    const qint64 maxOffset = *std::max_element( offsets.constBegin(), offsets.constEnd() );
+
+    const QDateTime first = QDateTime::fromSecsSinceEpoch( inFirstSecs - maxOffset, QTimeZone::utc() );
+    const QDateTime last = QDateTime::fromSecsSinceEpoch( inEndSecs - minOffset, QTimeZone::utc() );
+    QVector<DateTime> starts;
+    app->occurrenceStarts( DateTime( first.date(), first.time(), QTimeZone::utc() ),
+                           DateTime( last.date(), last.time(), QTimeZone::utc() ), starts );
+
+    for( const DateTime &start : starts )
+    {
+        const qint64 startSecs = start.toSecsSinceEpoch();
+        for( const qint64 offset : offsets )
+        {
+            const qint64 triggerSecs = startSecs + offset;
+            if( triggerSecs < inFirstSecs or triggerSecs >= inEndSecs )
+                continue;
+            m_heap.append( Trigger{ triggerSecs, inAppointmentIndex, start } );
+            std::push_heap( m_heap.begin(), m_heap.end(), isLater );
+        }
+    }
+}
+
+
+/* one timer for everything: the earliest trigger or the end of the window */
+void AlarmScheduler::rearm()
+{
+    if( m_appointments.isEmpty() )
+    {
+        m_timer->stop();
+        return;
+    }
+    qint64 nextSecs = m_windowEndSecs;
+    if( not m_heap.isEmpty() and m_heap.first().m_triggerSecs < nextSecs )
+        nextSecs = m_heap.first().m_triggerSecs;
+    const qint64 msecs = nextSecs * 1000 - QDateTime::currentMSecsSinceEpoch();
+    m_timer->start( static_cast<int>( qBound( static_cast<qint64>( 0 ), msecs,
+                                              static_cast<qint64>( std::numeric_limits<int>::max() ) ) ) );
+}
+
+
+void AlarmScheduler::slotTimeout()
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    while( not m_heap.isEmpty() and m_heap.first().m_triggerSecs <= now )
+    {
+        std::pop_heap( m_heap.begin(), m_heap.end(), isLater );
+        const Trigger trigger = m_heap.takeLast();
+        const Appointment* app = m_appointments.at( trigger.m_appointmentIndex );
+        emit signalAlarm( app->m_uid, app->m_appBasics->m_summary, trigger.m_eventStart );
+    }
+
+    if( m_windowEndSecs <= now )
+    {
+        // after a suspend, the triggers missed in between are dropped
+        qint64 firstSecs = m_windowEndSecs;
+        if( firstSecs < now - 60 )
+            firstSecs = now;
+        m_windowEndSecs = now + ALARM_WINDOW_SECS;
+        fillWindow( firstSecs, m_windowEndSecs );
+    }
+    rearm();
+}
@@ -0,0 +1,77 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef ALARMSCHEDULER_H
+#define ALARMSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include "appointmentmanager.h"
+
+
+/* Fires the alarms of appointments.
+ * Trigger times are not made in advance. For a window of ALARM_WINDOW_SECS, each
+ *  appointment is asked for its occurrences (Appointment::occurrenceStarts()) and
+ *  the trigger times of its alarms go into a min-heap. One single-shot QTimer is
+ *  armed to the earliest trigger or to the end of the window, whichever comes first.
+ *  So nothing runs between two alarms, no matter how many appointments have alarms.
+ *  At the end of a window, the next one is filled.
+ */
+class AlarmScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int ALARM_WINDOW_SECS = 86400;
+
+    explicit AlarmScheduler( QObject* parent = Q_NULLPTR );
+    ~AlarmScheduler();
+
+    /* replaces all appointments, we own them now. They do not need an event list,
+     *  see Storage::loadAppointmentsWithAlarms(). Alarms before now are not fired. */
+    void setAppointments( const QVector<Appointment*> &inAppointments );
+
+private:
+    struct Trigger
+    {
+        qint64      m_triggerSecs;
+        int         m_appointmentIndex;
+        DateTime    m_eventStart;
+    };
+
+    // heap order: the earliest trigger on top
+    static bool isLater( const Trigger &inA, const Trigger &inB );
+
+    void fillWindow( const qint64 inFirstSecs, const qint64 inEndSecs );
+    void addTriggers( const int inAppointmentIndex, const qint64 inFirstSecs, const qint64 inEndSecs );
+    void rearm();
+
+    QVector<Appointment*>   m_appointments;
+    QVector<Trigger>        m_heap;
+    QTimer*                 m_timer;
+    qint64                  m_windowEndSecs;    // triggers before this are in m_heap
+
+signals:
+    // inEventStart is the start of the occurrence, the alarm belongs to
+    void signalAlarm( const QString inUid, const QString inSummary, const DateTime inEventStart );
+
+private slots:
+    void slotTimeout();
+};
+
+#endif // ALARMSCHEDULER_H
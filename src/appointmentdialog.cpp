@@ -52,6 +52,9 @@ AppointmentDialog::AppointmentDialog( QWidget* parent ) :
     m_ui->basic_repeattype_combo->addItem( "monthly", MONTHLY );
     m_ui->basic_repeattype_combo->addItem( "weekly", WEEKLY );
     m_ui->basic_repeattype_combo->addItem( "daily", DAILY );
+    m_ui->basic_repeattype_combo->addItem( "hourly", HOURLY );
+    m_ui->basic_repeattype_combo->addItem( "minutely", MINUTELY );
+    m_ui->basic_repeattype_combo->addItem( "secondly", SECONDLY );
 
     // it starts on monday and iterates over all weekdays
     QDate d(2018, 1, 1);
@@ -400,6 +403,15 @@ void AppointmentDialog::setAppointmentDataToBasicPage( const Appointment* apmDat
             case AppointmentRecurrence::RFT_DAILY:
                 m_ui->basic_repeattype_combo->setCurrentIndex( DAILY );
             break;
+            case AppointmentRecurrence::RFT_HOURLY:
+                m_ui->basic_repeattype_combo->setCurrentIndex( HOURLY );
+            break;
+            case AppointmentRecurrence::RFT_MINUTELY:
+                m_ui->basic_repeattype_combo->setCurrentIndex( MINUTELY );
+            break;
+            case AppointmentRecurrence::RFT_SECONDLY:
+                m_ui->basic_repeattype_combo->setCurrentIndex( SECONDLY );
+            break;
             default:
                 qDebug() << "ERR: unimplemented Selector in AppointmentDialog::setAppointmentValues()";
                 Q_ASSERT( false );
@@ -549,6 +561,11 @@ void AppointmentDialog::collectAppointmentDataFromBasicPage()
                         complex_recurrence ? AppointmentRecurrence::RFT_DAILY :
                                              AppointmentRecurrence::RFT_SIMPLE_DAILY;
             break;
+            case AppointmentRecurrence::RFT_HOURLY:
+            case AppointmentRecurrence::RFT_MINUTELY:
+            case AppointmentRecurrence::RFT_SECONDLY:
+                // no simple form
+            break;
             default:
                 qDebug() << "ERR: unimplemented Selector in AppointmentDialog::collectAppointmentDataFromRecurrencePage()";
                 Q_ASSERT( false );
@@ -682,6 +699,54 @@ void AppointmentDialog::slotIndexChangedRecurrenceFrequency( int index )
             }
             m_appointment->m_appRecurrence->m_frequency = AppointmentRecurrence::RFT_DAILY;
         break;
+        case HOURLY:
+            m_ui->rec_page_bymonth->setEnabled( true );
+            m_ui->rec_page_byweekno->setEnabled( false );
+            m_ui->rec_page_byyearday->setEnabled( true );
+            m_ui->rec_page_bymonthday->setEnabled( true );
+            m_ui->rec_page_byday->setEnabled( true );
+            m_ui->rec_byday_daynumber->setEnabled( false );
+            m_ui->rec_page_misc->setEnabled( true );
+            m_ui->rec_misc_repeat_intervalnumber->setSuffix( " hours" );
+            if( not m_appointment->m_haveRecurrence )
+            {
+                m_appointment->m_haveRecurrence = true;
+                m_appointment->m_appRecurrence = new AppointmentRecurrence();
+            }
+            m_appointment->m_appRecurrence->m_frequency = AppointmentRecurrence::RFT_HOURLY;
+        break;
+        case MINUTELY:
+            m_ui->rec_page_bymonth->setEnabled( true );
+            m_ui->rec_page_byweekno->setEnabled( false );
+            m_ui->rec_page_byyearday->setEnabled( true );
+            m_ui->rec_page_bymonthday->setEnabled( true );
+            m_ui->rec_page_byday->setEnabled( true );
+            m_ui->rec_byday_daynumber->setEnabled( false );
+            m_ui->rec_page_misc->setEnabled( true );
+            m_ui->rec_misc_repeat_intervalnumber->setSuffix( " minutes" );
+            if( not m_appointment->m_haveRecurrence )
+            {
+                m_appointment->m_haveRecurrence = true;
+                m_appointment->m_appRecurrence = new AppointmentRecurrence();
+            }
+            m_appointment->m_appRecurrence->m_frequency = AppointmentRecurrence::RFT_MINUTELY;
+        break;
+        case SECONDLY:
+            m_ui->rec_page_bymonth->setEnabled( true );
+            m_ui->rec_page_byweekno->setEnabled( false );
+            m_ui->rec_page_byyearday->setEnabled( true );
+            m_ui->rec_page_bymonthday->setEnabled( true );
+            m_ui->rec_page_byday->setEnabled( true );
+            m_ui->rec_byday_daynumber->setEnabled( false );
+            m_ui->rec_page_misc->setEnabled( true );
+            m_ui->rec_misc_repeat_intervalnumber->setSuffix( " seconds" );
+            if( not m_appointment->m_haveRecurrence )
+            {
+                m_appointment->m_haveRecurrence = true;
+                m_appointment->m_appRecurrence = new AppointmentRecurrence();
+            }
+            m_appointment->m_appRecurrence->m_frequency = AppointmentRecurrence::RFT_SECONDLY;
+        break;
         default:
             m_ui->rec_page_bymonth->setDisabled( true );
             m_ui->rec_page_byweekno->setDisabled( true );
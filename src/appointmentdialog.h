@@ -44,7 +44,8 @@ class AppointmentDialog : public QDialog
     // just for a combobox.
     // this looks like duplicated code, see appointmentmanager.h (Recurrence) for details
     enum RecurrenceFrequencyType {
-        NO_RECURRENCE, YEARLY, MONTHLY, WEEKLY, DAILY
+        NO_RECURRENCE, YEARLY, MONTHLY, WEEKLY, DAILY,
+        HOURLY, MINUTELY, SECONDLY
     };
 
     /* values for radiobuttons Recurrence/Misc/Repeat.
@@ -19,6 +19,7 @@
 
 #include <algorithm>
 
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QRandomGenerator>
 #include <QRegularExpression>
@@ -74,7 +75,8 @@ AppointmentBasics::AppointmentBasics()
       m_uid(""),
       m_sequence(1),
       m_summary(""),
-      m_description("")
+      m_description(""),
+      m_busyFree(BUSY)      // TRANSP defaults to OPAQUE
 {
 }
 
@@ -130,7 +132,7 @@ AppointmentAlarm::AppointmentAlarm( const AppointmentAlarm &other )
 {
     m_alarmSecs = other.m_alarmSecs;
     m_repeatNumber = other.m_repeatNumber;
-    m_pauseSecs = other.m_repeatNumber;
+    m_pauseSecs = other.m_pauseSecs;
 }
 
 
@@ -220,7 +222,7 @@ QString AppointmentRecurrence::contentToString() const
         ed = "[exdates:no]";
     else
     {
-        for( DateTime d : m_exceptionDates )
+        for( const DateTime &d : m_exceptionDates )
             ed = ed.append( QString( "(ed:%1)").arg(d.toString() ) );
         ed = ed.prepend( "[exdates:");
         ed = ed.append( "]" );
@@ -231,7 +233,7 @@ QString AppointmentRecurrence::contentToString() const
         fd = "[fixedInterval:no]";
     else
     {
-        for( RecurringFixedIntervals interval : m_recurFixedIntervals )
+        for( const RecurringFixedIntervals &interval : m_recurFixedIntervals )
             fd = fd.append( QString( "(inter:%1)").arg( interval.toIntervalElementString() ) );
         fd = fd.prepend( "[fixedInterval:");
         fd = fd.append( "]" );
@@ -350,6 +352,13 @@ QString AppointmentRecurrence::contentToString() const
 }
 
 
+bool AppointmentRecurrence::isSubDaily() const
+{
+    return m_frequency == RFT_HOURLY or m_frequency == RFT_MINUTELY or
+            m_frequency == RFT_SECONDLY;
+}
+
+
 QVector<DateTime> AppointmentRecurrence::recurrenceStartDates( const DateTime inDtStart )
 {
     DateTime lastDt;
@@ -357,6 +366,15 @@ QVector<DateTime> AppointmentRecurrence::recurrenceStartDates( const DateTime in
         lastDt = m_until;
     else
         lastDt.readDateTime( "21001231", true );
+    return recurrenceStartDates( inDtStart, lastDt );
+}
+
+
+QVector<DateTime> AppointmentRecurrence::recurrenceStartDates( const DateTime inDtStart, const DateTime inDtLast )
+{
+    DateTime lastDt = inDtLast;
+    if( m_until.isValid() and m_until < lastDt )
+        lastDt = m_until;
 
     if( m_frequency == RFT_SIMPLE_YEARLY )
         return recurrenceStartDatesSimpleYearly( inDtStart, lastDt );
@@ -572,7 +590,7 @@ QVector<DateTime> AppointmentRecurrence::recurrenceStartDatesYearly( const DateT
                 weekExpand( runner, week, tempList );
             if( have_byDay )                // BYWEEKNO + BYDAY
             {
-                for( DateTime dt : tempList )
+                for( const DateTime &dt : tempList )
                 {
                     int weekDay = dt.date().dayOfWeek();
                     if( not ( daysetContainsDay( m_byDaySet, static_cast<WeekDay>(weekDay) ) and
@@ -587,7 +605,7 @@ QVector<DateTime> AppointmentRecurrence::recurrenceStartDatesYearly( const DateT
                 // Read 3.3.10: "Information, not contained in the rule,necessary ... are derived from
                 // the Start Time ("DTSTART") component attribute. "
                 int weekDayStart = inDtStart.date().dayOfWeek();
-                for( DateTime dt : tempList )
+                for( const DateTime &dt : tempList )
                 {
                     int weekDay = dt.date().dayOfWeek();
                     if( not (( weekDay == weekDayStart ) and validateDateTime( dt )) )
@@ -627,7 +645,7 @@ QVector<DateTime> AppointmentRecurrence::recurrenceStartDatesYearly( const DateT
             QDate start( runner.date().year(), 1, 1 );
             QDate end( runner.date().year(), 12, 31 );
 
-            for( const std::pair<WeekDay, int> dayItem : m_byDaySet )
+            for( const std::pair<WeekDay, int> &dayItem : m_byDaySet )
             {
                 WeekDay weekDay = dayItem.first;
                 const int relDay = dayItem.second;
@@ -700,7 +718,7 @@ QVector<DateTime> AppointmentRecurrence::recurrenceStartDatesYearly( const DateT
             QVector<QTime> timeList;
             QVector<DateTime> targetAndTimeMerged;
             timeExpand( runner, m_byHourSet, m_byMinuteSet, m_bySecondSet, timeList );
-            for( DateTime dt : yearTargetList )
+            for( const DateTime &dt : yearTargetList )
             {
                 for( const QTime t : timeList )
                 {
@@ -813,7 +831,7 @@ QVector<DateTime> AppointmentRecurrence::recurrenceStartDatesMonthly( const Date
             QDate start( runner.date().year(), runner.date().month(), 1 );
             QDate end( start.year(), start.month(), start.daysInMonth() );
 
-            for( const std::pair<WeekDay, int> dayItem : m_byDaySet )
+            for( const std::pair<WeekDay, int> &dayItem : m_byDaySet )
             {
                 WeekDay weekDay = dayItem.first;
                 const int relDay = dayItem.second;
@@ -886,7 +904,7 @@ QVector<DateTime> AppointmentRecurrence::recurrenceStartDatesMonthly( const Date
             QVector<QTime> timeList;
             QVector<DateTime> targetAndTimeMerged;
             timeExpand( runner, m_byHourSet, m_byMinuteSet, m_bySecondSet, timeList );
-            for( DateTime dt : monthTargetList )
+            for( const DateTime &dt : monthTargetList )
             {
                 for( const QTime t : timeList )
                 {
@@ -1018,7 +1036,7 @@ QVector<DateTime> AppointmentRecurrence::recurrenceStartDatesWeekly( const DateT
             QVector<QTime> timeList;
             QVector<DateTime> targetAndTimeMerged;
             timeExpand( runner, m_byHourSet, m_byMinuteSet, m_bySecondSet, timeList );
-            for( DateTime dt : weekTargetList )
+            for( const DateTime &dt : weekTargetList )
             {
                 for( const QTime t : timeList )
                 {
@@ -1166,7 +1184,7 @@ QVector<DateTime> AppointmentRecurrence::recurrenceStartDatesDaily( const DateTi
             QVector<QTime> timeList;
             QVector<DateTime> targetAndTimeMerged;
             timeExpand( runner, m_byHourSet, m_byMinuteSet, m_bySecondSet, timeList );
-            for( DateTime dt : dayTargetList )
+            for( const DateTime &dt : dayTargetList )
             {
                 for( const QTime t : timeList )
                 {
@@ -1321,14 +1339,14 @@ QDate AppointmentRecurrence::firstDayOfWeek( const int inYear, const int inWeekN
 }
 
 
-bool AppointmentRecurrence::validateDateTime( const DateTime inRefTime ) const
+bool AppointmentRecurrence::validateDateTime( const DateTime &inRefTime ) const
 {
     // reject invalid dates
     if( not inRefTime.isValid() )
         return false;
     if( m_exceptionDates.count() > 0 )
     {
-        for( const DateTime dt : m_exceptionDates )
+        for( const DateTime &dt : m_exceptionDates )
         {
             if( inRefTime == dt or
                 ( dt.isDate() and inRefTime.date() == dt.date() ) )
@@ -1347,6 +1365,249 @@ void AppointmentRecurrence::sortDaytimeList(QVector<DateTime> &inoutSortVector )
 }
 
 
+/* ***********************************************
+ * ******* RecurrenceIterator ********************
+ * **********************************************/
+
+RecurrenceIterator::RecurrenceIterator( const AppointmentRecurrence &inRecurrence, const DateTime &inDtStart )
+    :
+      m_recurrence( inRecurrence ),
+      m_dtStart( inDtStart ),
+      m_startSecs( inDtStart.toSecsSinceEpoch() ),
+      m_period( 0 ),
+      m_offsetIndex( 0 ),
+      m_numDelivered( 0 ),
+      m_checkpoints( nullptr )
+{
+    const int interval = qMax( 1, m_recurrence.m_interval );
+    const QTime t = m_dtStart.time();
+    QSet<int> minutes = m_recurrence.m_byMinuteSet;
+    QSet<int> seconds = m_recurrence.m_bySecondSet;
+    if( minutes.isEmpty() )
+        minutes.insert( t.minute() );
+    if( seconds.isEmpty() )
+        seconds.insert( t.second() );
+
+    switch( m_recurrence.m_frequency )
+    {
+        case AppointmentRecurrence::RFT_HOURLY:
+            m_baseSecs = m_startSecs - t.minute() * 60 - t.second();
+            m_stepSecs = 3600 * interval;
+            for( const int minute : minutes )
+            {
+                for( const int second : seconds )
+                {
+                    if( minute >= 0 and minute < 60 and second >= 0 and second < 60 )
+                        m_offsets.append( minute * 60 + second );
+                }
+            }
+        break;
+        case AppointmentRecurrence::RFT_MINUTELY:
+            m_baseSecs = m_startSecs - t.second();
+            m_stepSecs = 60 * interval;
+            for( const int second : seconds )
+            {
+                if( second >= 0 and second < 60 )
+                    m_offsets.append( second );
+            }
+        break;
+        default:
+            m_baseSecs = m_startSecs;
+            m_stepSecs = interval;
+            m_offsets.append( 0 );
+        break;
+    }
+    std::sort( m_offsets.begin(), m_offsets.end() );
+
+    // same limit as recurrenceStartDates()
+    DateTime lastDt;
+    if( m_recurrence.m_until.isValid() )
+        lastDt = m_recurrence.m_until;
+    else
+        lastDt.readDateTime( "21001231", true );
+    m_lastSecs = lastDt.toSecsSinceEpoch();
+
+    // expanded times before DTSTART do not count
+    jumpTo( m_startSecs );
+}
+
+
+void RecurrenceIterator::seekTo( const DateTime &inDt )
+{
+    const qint64 secs = inDt.toSecsSinceEpoch();
+    if( m_recurrence.m_count <= 0 )
+    {
+        jumpTo( secs );
+        return;
+    }
+    // COUNT starts at DTSTART, so every skipped start date has to be counted, from the last checkpoint on
+    if( m_checkpoints and not m_checkpoints->isEmpty() )
+    {
+        auto it = std::upper_bound( m_checkpoints->constBegin(), m_checkpoints->constEnd(), secs,
+                                    []( const qint64 inSecs, const Position &p ) { return inSecs < p.m_secs; } );
+        if( it != m_checkpoints->constBegin() )
+        {
+            --it;
+            if( it->m_numDelivered > m_numDelivered )
+            {
+                m_period = it->m_period;
+                m_offsetIndex = it->m_offsetIndex;
+                m_numDelivered = it->m_numDelivered;
+            }
+        }
+    }
+    while( findCandidate() and candidateSecs() < secs )
+    {
+        countCandidate();
+        advance();
+    }
+}
+
+
+void RecurrenceIterator::setCheckpoints( QVector<Position>* inoutCheckpoints )
+{
+    m_checkpoints = inoutCheckpoints;
+}
+
+
+void RecurrenceIterator::countCandidate()
+{
+    // checkpoints are appended in order, each one once
+    if( m_checkpoints and m_recurrence.m_count > 0 and m_numDelivered % CHECKPOINT_STEP == 0 and
+        ( m_checkpoints->isEmpty() or m_checkpoints->constLast().m_numDelivered < m_numDelivered ) )
+        m_checkpoints->append( Position{ candidateSecs(), m_period, m_offsetIndex, m_numDelivered } );
+    m_numDelivered++;
+}
+
+
+bool RecurrenceIterator::next( DateTime &outDt )
+{
+    if( not findCandidate() )
+        return false;
+    outDt = m_candidate;
+    countCandidate();
+    advance();
+    return true;
+}
+
+
+qint64 RecurrenceIterator::candidateSecs() const
+{
+    return m_baseSecs + m_period * m_stepSecs + m_offsets.at( m_offsetIndex );
+}
+
+
+void RecurrenceIterator::advance()
+{
+    m_offsetIndex++;
+    if( m_offsetIndex >= m_offsets.count() )
+    {
+        m_offsetIndex = 0;
+        m_period++;
+    }
+}
+
+
+void RecurrenceIterator::jumpTo( const qint64 inSecs )
+{
+    if( m_offsets.isEmpty() or inSecs <= candidateSecs() )
+        return;
+    m_period = ( inSecs - m_baseSecs ) / m_stepSecs;
+    const int periodOffset = static_cast<int>( inSecs - m_baseSecs - m_period * m_stepSecs );
+    auto it = std::lower_bound( m_offsets.constBegin(), m_offsets.constEnd(), periodOffset );
+    if( it == m_offsets.constEnd() )
+    {
+        m_period++;
+        m_offsetIndex = 0;
+    }
+    else
+        m_offsetIndex = static_cast<int>( it - m_offsets.constBegin() );
+}
+
+
+bool RecurrenceIterator::findCandidate()
+{
+    if( m_offsets.isEmpty() )
+        return false;
+    while( true )
+    {
+        if( m_recurrence.m_count > 0 and m_numDelivered >= m_recurrence.m_count )
+            return false;
+        const qint64 secs = candidateSecs();
+        if( secs > m_lastSecs )
+            return false;
+        const QDateTime qdt = QDateTime::fromSecsSinceEpoch( secs, m_dtStart.timeZone() );
+        m_candidate = DateTime( qdt.date(), qdt.time(), m_dtStart.timeZone(), false );
+        qint64 skipSecs = 0;
+        if( not matchesByRules( m_candidate, skipSecs ) )
+        {
+            advance();
+            jumpTo( skipSecs );
+            continue;
+        }
+        if( m_recurrence.validateDateTime( m_candidate ) )
+            return true;
+        advance();
+    }
+}
+
+
+bool RecurrenceIterator::matchesByRules( const DateTime &inDt, qint64 &outSkipSecs ) const
+{
+    const QDate d = inDt.date();
+    const QTime t = inDt.time();
+    const qint64 secs = inDt.toSecsSinceEpoch();
+
+    if( not m_recurrence.m_byMonthSet.isEmpty() and
+        not m_recurrence.m_byMonthSet.contains( d.month() ) )
+    {
+        QDate nextMonth = QDate( d.year(), d.month(), 1 ).addMonths( 1 );
+        outSkipSecs = QDateTime( nextMonth, QTime( 0, 0 ), m_dtStart.timeZone() ).toSecsSinceEpoch();
+        return false;
+    }
+
+    // negative values count from the end of the year or month
+    bool dayMatches = true;
+    if( not m_recurrence.m_byYearDaySet.isEmpty() )
+        dayMatches = m_recurrence.m_byYearDaySet.contains( d.dayOfYear() ) or
+                m_recurrence.m_byYearDaySet.contains( d.dayOfYear() - d.daysInYear() - 1 );
+    if( dayMatches and not m_recurrence.m_byMonthDaySet.isEmpty() )
+        dayMatches = m_recurrence.m_byMonthDaySet.contains( d.day() ) or
+                m_recurrence.m_byMonthDaySet.contains( d.day() - d.daysInMonth() - 1 );
+    if( dayMatches and m_recurrence.m_byDaySet.size() > 0 )
+        dayMatches = m_recurrence.daysetContainsDay( m_recurrence.m_byDaySet,
+                                                     static_cast<AppointmentRecurrence::WeekDay>( d.dayOfWeek() ) );
+    if( not dayMatches )
+    {
+        outSkipSecs = QDateTime( d.addDays( 1 ), QTime( 0, 0 ), m_dtStart.timeZone() ).toSecsSinceEpoch();
+        return false;
+    }
+
+    if( not m_recurrence.m_byHourSet.isEmpty() and
+        not m_recurrence.m_byHourSet.contains( t.hour() ) )
+    {
+        outSkipSecs = secs - t.minute() * 60 - t.second() + 3600;
+        return false;
+    }
+    // for HOURLY, BYMINUTE and BYSECOND are already expanded, for MINUTELY BYSECOND is
+    if( m_recurrence.m_frequency != AppointmentRecurrence::RFT_HOURLY and
+        not m_recurrence.m_byMinuteSet.isEmpty() and
+        not m_recurrence.m_byMinuteSet.contains( t.minute() ) )
+    {
+        outSkipSecs = secs - t.second() + 60;
+        return false;
+    }
+    if( m_recurrence.m_frequency == AppointmentRecurrence::RFT_SECONDLY and
+        not m_recurrence.m_bySecondSet.isEmpty() and
+        not m_recurrence.m_bySecondSet.contains( t.second() ) )
+    {
+        outSkipSecs = secs + 1;
+        return false;
+    }
+    return true;
+}
+
+
 /* ***********************************************
  * ******* Appointment ***************************
  * **********************************************/
@@ -1359,7 +1620,8 @@ Appointment::Appointment( QObject* parent )
       m_userCalendarId(0),
       m_uid(""),
       m_haveRecurrence( false ),
-      m_haveAlarm( false )
+      m_haveAlarm( false ),
+      m_haveCountedStarts( false )
 {
 
 }
@@ -1385,6 +1647,76 @@ bool Appointment::isPartiallyEqual( const Appointment &other ) const
 }
 
 
+QByteArray Appointment::contentHash() const
+{
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    // QSet has no stable order
+    auto addIntSet = [&hash]( const QSet<int> &inSet )
+    {
+        QList<int> values = inSet.values();
+        std::sort( values.begin(), values.end() );
+        for( const int i : values )
+            hash.addData( QByteArray::number( i ).append( ',' ) );
+        hash.addData( ";" );
+    };
+    auto addString = [&hash]( const QString &inString )
+    {
+        hash.addData( inString.toUtf8() );
+        hash.addData( QByteArray( 1, '\0' ) );
+    };
+
+    QString dtString;
+    QString tzString;
+    addString( m_uid );
+    addString( QString::number( m_userCalendarId ) );
+    if( m_appBasics )
+    {
+        addString( QString::number( m_appBasics->m_sequence ) );
+        DateTime::dateTime2Strings( m_appBasics->m_dtStart, dtString, tzString );
+        addString( dtString );
+        addString( tzString );
+        DateTime::dateTime2Strings( m_appBasics->m_dtEnd, dtString, tzString );
+        addString( dtString );
+        addString( tzString );
+        addString( m_appBasics->m_summary );
+        addString( m_appBasics->m_description );
+        addString( QString::number( static_cast<int>(m_appBasics->m_busyFree) ) );
+    }
+    for( const AppointmentAlarm* alarm : m_appAlarms )
+        addString( QString( "%1,%2,%3" )
+                   .arg( alarm->m_alarmSecs )
+                   .arg( alarm->m_repeatNumber )
+                   .arg( alarm->m_pauseSecs ) );
+    if( m_haveRecurrence and m_appRecurrence )
+    {
+        addString( QString( "%1,%2,%3,%4" )
+                   .arg( static_cast<int>(m_appRecurrence->m_frequency) )
+                   .arg( m_appRecurrence->m_count )
+                   .arg( m_appRecurrence->m_interval )
+                   .arg( static_cast<int>(m_appRecurrence->m_startWeekday) ) );
+        DateTime::dateTime2Strings( m_appRecurrence->m_until, dtString, tzString );
+        addString( dtString );
+        addString( tzString );
+        makeStringsFromDateVector( m_appRecurrence->m_exceptionDates, dtString, tzString );
+        addString( dtString );
+        addString( tzString );
+        makeStringFromFixedIntervalVector( m_appRecurrence->m_recurFixedIntervals, dtString );
+        addString( dtString );
+        makeStringFromDayset( m_appRecurrence->m_byDaySet, dtString );
+        addString( dtString );
+        addIntSet( m_appRecurrence->m_byMonthSet );
+        addIntSet( m_appRecurrence->m_byWeekNumberSet );
+        addIntSet( m_appRecurrence->m_byYearDaySet );
+        addIntSet( m_appRecurrence->m_byMonthDaySet );
+        addIntSet( m_appRecurrence->m_byHourSet );
+        addIntSet( m_appRecurrence->m_byMinuteSet );
+        addIntSet( m_appRecurrence->m_bySecondSet );
+        addIntSet( m_appRecurrence->m_bySetPosSet );
+    }
+    return hash.result().toHex();
+}
+
+
 void Appointment::generateUid()
 {
     QDateTime dt = QDateTime::currentDateTime().toUTC();
@@ -1398,7 +1730,7 @@ void Appointment::generateUid()
 void Appointment::makeDateVector( const QString inElementsString, const QString inTimeZone, QVector<DateTime> &outVector )
 {
     outVector.clear();
-    for( const QString s : inElementsString.split( ',', QString::SkipEmptyParts ) )
+    for( const QString &s : inElementsString.split( ',', QString::SkipEmptyParts ) )
     {
         DateTime dt;
         dt.readDateTime( s );
@@ -1419,7 +1751,7 @@ void Appointment::makeDayset( const QString inElementsString, std::set<std::pair
     bool ok = false;
     QRegularExpression re( "([+-]?\\d*)(\\D*)" );
     AppointmentRecurrence::WeekDay weekDay = AppointmentRecurrence::WD_MO;
-    for( const QString elem : inElementsString.split( ',', QString::SkipEmptyParts ) )
+    for( const QString &elem : inElementsString.split( ',', QString::SkipEmptyParts ) )
     {
         QRegularExpressionMatch match = re.match( elem );
         QString vString = match.captured( 1 );
@@ -1447,7 +1779,7 @@ void Appointment::makeIntSet( const QString inElementsString, QSet<int> &outSet
 {
     outSet.clear();
     bool ok;
-    for( const QString s : inElementsString.split( ',', QString::SkipEmptyParts ) )
+    for( const QString &s : inElementsString.split( ',', QString::SkipEmptyParts ) )
     {
         outSet.insert( s.toInt(&ok) );
     }
@@ -1458,7 +1790,7 @@ void Appointment::makeFixedIntervalVector( const QString inElementsString, QVect
 {
     outVector.clear();
     QStringList elements = inElementsString.split( ';', QString::SkipEmptyParts );
-    for( QString intervalText : elements )
+    for( const QString &intervalText : elements )
     {
         RecurringFixedIntervals interval;
         if( interval.readIntervalElementText( intervalText ) )
@@ -1480,7 +1812,7 @@ void Appointment::makeStringsFromDateVector( const QVector<DateTime> &inVector,
     bool have_tz = false;
     outDtString = "";
     outTzString = "";
-    for( const DateTime dt : inVector )
+    for( const DateTime &dt : inVector )
     {
         QString s;
         num++;
@@ -1559,7 +1891,7 @@ void Appointment::makeStringFromIntSet( const QSet<int> inIntSet, QString &outSt
 void Appointment::makeStringFromFixedIntervalVector( const QVector<RecurringFixedIntervals> &inVector, QString &outString )
 {
     outString = "";
-    for( RecurringFixedIntervals interval : inVector )
+    for( const RecurringFixedIntervals &interval : inVector )
         outString = outString.append( interval.toIntervalElementString() ).append( ';' );
 }
 
@@ -1572,26 +1904,33 @@ void Appointment::makeEvents()
         connect( m_appRecurrence, SIGNAL(signalTick(int,int,int)),
               this, SIGNAL(sigTickEvent(int,int,int)) );
 
-        QVector<DateTime> list = m_appRecurrence->recurrenceStartDates( m_appBasics->m_dtStart );
-
         // RRULE
-        if( not list.isEmpty() )
+        if( m_appRecurrence->isSubDaily() )
+            makeStreamedYears();
+        else
         {
-            m_minYear = list.constLast().date().year();
-            m_maxYear = list.constFirst().date().year();
-            qint64 seconds = m_appBasics->m_dtStart.secsTo( m_appBasics->m_dtEnd );
-
-            for( const DateTime dt : list )
+            QVector<DateTime> list = m_appRecurrence->recurrenceStartDates( m_appBasics->m_dtStart );
+            if( not list.isEmpty() )
             {
-                makeRruleEvents( dt, seconds );
+                m_minYear = list.constLast().date().year();
+                m_maxYear = list.constFirst().date().year();
+                qint64 seconds = m_appBasics->m_dtStart.secsTo( m_appBasics->m_dtEnd );
+
+                m_eventVector.reserve( m_eventVector.count() + list.count() +
+                                       m_appRecurrence->m_recurFixedIntervals.count() + 1 );
+                for( const DateTime &dt : list )
+                {
+                    makeRruleEvents( dt, seconds );
+                }
             }
         }
         // RDATE
-        for( const RecurringFixedIntervals interval : m_appRecurrence->m_recurFixedIntervals )
+        for( const RecurringFixedIntervals &interval : m_appRecurrence->m_recurFixedIntervals )
         {
             makeRDateEvents( interval );
         }
-        if( not m_appRecurrence->m_recurFixedIntervals.isEmpty() )
+        // streamed recurrences deliver their start date themselves
+        if( not m_appRecurrence->m_recurFixedIntervals.isEmpty() and not isStreamed() )
         {
             // for RDATEs, append the start date of the appointment.
             if( not eventVectorContainsStartdate( m_appBasics->m_dtStart ) )
@@ -1615,11 +1954,66 @@ void Appointment::makeEvents()
 
 void Appointment::setEventColor( const QColor inEventColor )
 {
+    m_eventColor = inEventColor;
     for( Event &e : m_eventVector )
         e.m_eventColor = inEventColor;
 }
 
 
+bool Appointment::isStreamed() const
+{
+    return m_haveRecurrence and m_appRecurrence->isSubDaily();
+}
+
+
+void Appointment::appendStreamedEvents( const QDate &inFirst, const QDate &inLast,
+                                        const int inMaxEventsPerDay, QVector<Event> &outEvents ) const
+{
+    if( not isStreamed() )
+        return;
+
+    const QTimeZone timeZone = m_appBasics->m_dtStart.timeZone();
+    const qint64 seconds = m_appBasics->m_dtStart.secsTo( m_appBasics->m_dtEnd );
+    // events starting before inFirst may reach into it
+    const QDateTime seekDt = QDateTime( inFirst, QTime( 0, 0 ), timeZone ).addSecs( -seconds );
+
+    RecurrenceIterator it( *m_appRecurrence, m_appBasics->m_dtStart );
+    it.setCheckpoints( &m_streamCheckpoints );
+    it.seekTo( DateTime( seekDt.date(), seekDt.time(), timeZone, false ) );
+
+    DateTime startDt;
+    QDate day;
+    int numThisDay = 0;
+    while( it.next( startDt ) )
+    {
+        if( startDt.date() > inLast )
+            break;
+        const QDateTime endDt = startDt.addSecs( seconds );
+        if( endDt.date() < inFirst )
+            continue;
+        if( startDt.date() != day )
+        {
+            day = startDt.date();
+            numThisDay = 0;
+        }
+
+        Event e;
+        e.m_uid = m_appBasics->m_uid;
+        e.m_displayText = m_appBasics->m_summary;
+        e.m_startDt = startDt;
+        e.m_endDt = DateTime( endDt.date(), endDt.time(), endDt.timeZone(), false );
+        e.m_isAlarmEvent = false;
+        e.m_userCalendarId = m_userCalendarId;
+        e.m_eventColor = m_eventColor;
+        outEvents.append( std::move( e ) );
+
+        // the rest of the day is skipped, not walked
+        if( ++numThisDay >= inMaxEventsPerDay )
+            it.seekTo( DateTime( day.addDays( 1 ), QTime( 0, 0 ), timeZone, false ) );
+    }
+}
+
+
 void Appointment::makeSingleEvent()
 {
     Event e;
@@ -1629,11 +2023,11 @@ void Appointment::makeSingleEvent()
     e.m_endDt = m_appBasics->m_dtEnd;
     e.m_isAlarmEvent = false;
     e.m_userCalendarId = m_userCalendarId;
-    m_eventVector.append( e );
     m_yearsInQuestion.insert( e.m_startDt.date().year() );
     m_yearsInQuestion.insert( e.m_endDt.date().year() );
     m_minYear = e.m_startDt.date().year();
     m_maxYear = e.m_endDt.date().year();
+    m_eventVector.append( std::move( e ) );
 }
 
 
@@ -1646,7 +2040,7 @@ void Appointment::makeRDateEvents( const RecurringFixedIntervals &inInterval )
     e.m_endDt = inInterval.m_end;
     e.m_isAlarmEvent = false;
     e.m_userCalendarId = m_userCalendarId;
-    m_eventVector.append( e );
+    m_eventVector.append( std::move( e ) );
     m_yearsInQuestion.insert( inInterval.m_start.date().year() );
     m_yearsInQuestion.insert( inInterval.m_end.date().year() );
     m_minYear = inInterval.m_start.date().year() < m_minYear ? inInterval.m_start.date().year() : m_minYear;
@@ -1654,7 +2048,7 @@ void Appointment::makeRDateEvents( const RecurringFixedIntervals &inInterval )
 }
 
 
-void Appointment::makeRruleEvents( const DateTime inStartDate , qint64 inDeltaSeconds )
+void Appointment::makeRruleEvents( const DateTime &inStartDate , qint64 inDeltaSeconds )
 {
     Event e;
     e.m_uid = m_appBasics->m_uid;
@@ -1664,7 +2058,7 @@ void Appointment::makeRruleEvents( const DateTime inStartDate , qint64 inDeltaSe
     e.m_endDt = DateTime( qdt.date(), qdt.time(), qdt.timeZone(), e.m_startDt.isDate() );
     e.m_isAlarmEvent = false;
     e.m_userCalendarId = m_userCalendarId;
-    m_eventVector.append( e );
+    m_eventVector.append( std::move( e ) );
     m_yearsInQuestion.insert( inStartDate.date().year() );
     m_yearsInQuestion.insert( qdt.date().year() );
     m_minYear = inStartDate.date().year() < m_minYear ? inStartDate.date().year() : m_minYear;
@@ -1672,10 +2066,151 @@ void Appointment::makeRruleEvents( const DateTime inStartDate , qint64 inDeltaSe
 }
 
 
-bool Appointment::eventVectorContainsStartdate(const DateTime inStartDate ) const
+/* DTSTART moved forward by whole INTERVAL periods, to at least one period before inFirst.
+ * Without COUNT, expanding the rule from there gives the same start dates from inFirst on.
+ * The expansion adds months and years step by step, so a day after the 28th drifts in short
+ *  months. These rules start at DTSTART, to get the same drift as makeEvents(). */
+DateTime Appointment::windowStart( const DateTime &inDtStart, const DateTime &inFirst ) const
+{
+    const int interval = qMax( 1, m_appRecurrence->m_interval );
+    const QDate start = inDtStart.date();
+    const QDate first = inFirst.date();
+    switch( m_appRecurrence->m_frequency )
+    {
+        case AppointmentRecurrence::RFT_SIMPLE_DAILY:
+        case AppointmentRecurrence::RFT_DAILY:
+        {
+            const qint64 periods = start.daysTo( first ) / interval - 1;
+            if( periods > 0 )
+                return inDtStart.addDays( static_cast<int>( periods * interval ) );
+        }
+        break;
+        case AppointmentRecurrence::RFT_SIMPLE_WEEKLY:
+        case AppointmentRecurrence::RFT_WEEKLY:
+        {
+            const qint64 periods = start.daysTo( first ) / ( 7 * interval ) - 1;
+            if( periods > 0 )
+                return inDtStart.addDays( static_cast<int>( periods * 7 * interval ) );
+        }
+        break;
+        case AppointmentRecurrence::RFT_SIMPLE_MONTHLY:
+        case AppointmentRecurrence::RFT_MONTHLY:
+        {
+            const int periods = ( ( first.year() - start.year() ) * 12 + first.month() - start.month() ) / interval - 1;
+            if( periods > 0 and start.day() <= 28 )
+                return inDtStart.addMonths( periods * interval );
+        }
+        break;
+        case AppointmentRecurrence::RFT_SIMPLE_YEARLY:
+        case AppointmentRecurrence::RFT_YEARLY:
+        {
+            const int periods = ( first.year() - start.year() ) / interval - 1;
+            if( periods > 0 and not ( start.month() == 2 and start.day() == 29 ) )
+                return inDtStart.addYears( periods * interval );
+        }
+        break;
+        default:
+        break;
+    }
+    return inDtStart;
+}
+
+
+void Appointment::occurrenceStarts( const DateTime &inFirst, const DateTime &inLast, QVector<DateTime> &outStarts ) const
+{
+    const DateTime &dtStart = m_appBasics->m_dtStart;
+    if( not m_haveRecurrence )
+    {
+        if( dtStart >= inFirst and dtStart <= inLast )
+            outStarts.append( dtStart );
+        return;
+    }
+
+    // RRULE
+    if( m_appRecurrence->isSubDaily() )
+    {
+        RecurrenceIterator it( *m_appRecurrence, dtStart );
+        it.setCheckpoints( &m_streamCheckpoints );
+        it.seekTo( inFirst );
+        DateTime dt;
+        while( it.next( dt ) and dt <= inLast )
+            outStarts.append( dt );
+    }
+    else if( m_appRecurrence->m_count > 0 )
+    {
+        // COUNT counts from DTSTART, so the start dates are made once and kept
+        if( not m_haveCountedStarts )
+        {
+            m_countedStarts = m_appRecurrence->recurrenceStartDates( dtStart );
+            std::sort( m_countedStarts.begin(), m_countedStarts.end() );
+            m_haveCountedStarts = true;
+        }
+        auto it = std::lower_bound( m_countedStarts.constBegin(), m_countedStarts.constEnd(), inFirst );
+        for( ; it != m_countedStarts.constEnd() and *it <= inLast; ++it )
+            outStarts.append( *it );
+    }
+    else
+    {
+        // starts near inFirst and stops at inLast, not in 2100
+        for( const DateTime &dt : m_appRecurrence->recurrenceStartDates( windowStart( dtStart, inFirst ), inLast ) )
+        {
+            if( dt >= inFirst )
+                outStarts.append( dt );
+        }
+    }
+    // RDATE, like makeEvents() including the start date of the appointment
+    for( const RecurringFixedIntervals &interval : m_appRecurrence->m_recurFixedIntervals )
+    {
+        if( interval.m_start >= inFirst and interval.m_start <= inLast )
+            outStarts.append( interval.m_start );
+    }
+    if( not m_appRecurrence->m_recurFixedIntervals.isEmpty() and not isStreamed() and
+        dtStart >= inFirst and dtStart <= inLast )
+        outStarts.append( dtStart );
+
+    std::sort( outStarts.begin(), outStarts.end() );
+    outStarts.erase( std::unique( outStarts.begin(), outStarts.end() ), outStarts.end() );
+}
+
+
+/* Sub-daily recurrences keep no events, but storage needs to know the years */
+void Appointment::makeStreamedYears()
+{
+    m_streamCheckpoints.clear();
+    RecurrenceIterator it( *m_appRecurrence, m_appBasics->m_dtStart );
+    it.setCheckpoints( &m_streamCheckpoints );
+    DateTime first;
+    if( not it.next( first ) )
+        return;
+
+    DateTime last;
+    if( m_appRecurrence->m_count > 0 )
+    {
+        // the last start date is found by a walk, only checkpoints are kept
+        last = first;
+        DateTime dt;
+        while( it.next( dt ) )
+            last = dt;
+    }
+    else if( m_appRecurrence->m_until.isValid() )
+        last = m_appRecurrence->m_until;
+    else
+        last.readDateTime( "21001231", true );  // same limit as recurrenceStartDates()
+
+    const qint64 seconds = m_appBasics->m_dtStart.secsTo( m_appBasics->m_dtEnd );
+    const int firstYear = first.date().year();
+    const int lastYear = last.addSecs( seconds ).date().year();
+    m_minYear = firstYear < m_minYear ? firstYear : m_minYear;
+    m_maxYear = lastYear > m_maxYear ? lastYear : m_maxYear;
+    for( int year = firstYear; year <= lastYear; year++ )
+        m_yearsInQuestion.insert( year );
+}
+
+
+bool Appointment::eventVectorContainsStartdate(const DateTime &inStartDate ) const
 {
     bool found = false;
-    for( const Event e : m_eventVector )
+    for( const Event &e : m_eventVector )
     {
         if( e.m_startDt == inStartDate )
         {
@@ -1694,13 +2229,7 @@ void Appointment::sortAndRemoveEventDuplicates()
 
     std::sort( m_eventVector.begin(), m_eventVector.end() );
 
-    QVector<Event> newVector { m_eventVector.takeFirst() };
-
-    while ( not m_eventVector.isEmpty() )
-    {
-        Event e = m_eventVector.takeFirst();
-        if( not ( e == newVector.last() ) )
-            newVector.append( e );
-    }
-    m_eventVector = newVector;
+    // in place, duplicates are neighbours now
+    auto last = std::unique( m_eventVector.begin(), m_eventVector.end() );
+    m_eventVector.erase( last, m_eventVector.end() );
 }
@@ -23,6 +23,7 @@
 #include <set>
 #include <utility>
 
+#include <QByteArray>
 #include <QColor>
 #include <QDebug>
 #include <QSet>
@@ -104,9 +105,6 @@ struct AppointmentAlarm
     // for debugging
     QString contentToString() const;
 
-    // generates a list of alarm times base on appointment start times.
-    QVector<DateTime*> alarmTime( const QVector<DateTime> &inAppointmentTime );
-
     // === Data ===
     qint64  m_alarmSecs;        // first or only alarm in seconds rel. to DTSTART
     int     m_repeatNumber;     // number of repetitions after first alarm.
@@ -137,7 +135,9 @@ public:
         RFT_SIMPLE_WEEKLY,              // every tuesday: GNU/Linux User Group Meeting
         RFT_SIMPLE_DAILY,
         RFT_YEARLY, RFT_MONTHLY,
-        RFT_WEEKLY, RFT_DAILY
+        RFT_WEEKLY, RFT_DAILY,
+        // sub-daily rules are never made into an event list, see RecurrenceIterator
+        RFT_HOURLY, RFT_MINUTELY, RFT_SECONDLY
     };
 
     // === Methods ===
@@ -151,10 +151,15 @@ public:
     // for debugging
     QString     contentToString() const;
 
+    // true for HOURLY, MINUTELY and SECONDLY
+    bool        isSubDaily() const;
+
     // a list of dates, where the recurrence occurs
     // inDtStart is simply DTSTART,
     //  inDtLast is UNTIL - if UNTIL is valid - or a future date
     QVector<DateTime> recurrenceStartDates( const DateTime inDtStart );
+    // same, but stops at inDtLast, if this is before UNTIL
+    QVector<DateTime> recurrenceStartDates( const DateTime inDtStart, const DateTime inDtLast );
     QVector<DateTime> recurrenceStartDatesSimpleYearly( const DateTime inDtStart, const DateTime inDtLast );
     QVector<DateTime> recurrenceStartDatesSimpleMonthly( const DateTime inDtStart, const DateTime inDtLast );
     QVector<DateTime> recurrenceStartDatesSimpleWeekly( const DateTime inDtStart, const DateTime inDtLast );
@@ -195,15 +200,15 @@ public:
      * else true
      * @fixme: Ping: think about EXDATEs, RDATEs
      */
-    bool        validateDateTime( const DateTime inRefTime ) const ;
+    bool        validateDateTime( const DateTime &inRefTime ) const ;
 
     // sorts the list in place.
     void        sortDaytimeList( QVector<DateTime> &inoutSortVector );
 
-    bool daysetContainsDay( const std::set<std::pair<WeekDay, int>> inStdSet,
+    bool daysetContainsDay( const std::set<std::pair<WeekDay, int>> &inStdSet,
                             const WeekDay inWeekday ) const
     {
-        for( const std::pair<WeekDay, int> dayElem : inStdSet )
+        for( const std::pair<WeekDay, int> &dayElem : inStdSet )
         {
             if( dayElem.first == inWeekday )
                 return true;
@@ -239,6 +244,71 @@ signals:
 };
 
 
+/* Pull-based generator of the start dates of a sub-daily recurrence.
+ * The start dates are the DTSTART times of every INTERVALth hour, minute or second.
+ *  For HOURLY, BYMINUTE and BYSECOND expand the times within a period, for MINUTELY
+ *  BYSECOND does. All other BYxxx rules limit (RFC 5545, 3.3.10), BYWEEKNO and
+ *  BYSETPOS are ignored. EXDATE, COUNT and UNTIL apply as for the other frequencies.
+ * Nothing is stored, next() delivers one start date after the other in ascending order.
+ * seekTo() moves forward to the first start date at or after a given time, so a window
+ *  costs only the start dates inside of it. With COUNT, the start dates before the
+ *  window have to be counted. The walk starts at the last checkpoint before the window,
+ *  if the owner keeps checkpoints, see setCheckpoints(), otherwise at DTSTART.
+ */
+class RecurrenceIterator
+{
+public:
+    // larger COUNTs are not streamed, see IcalInterpreter::eventHasUsableRRuleOrNone()
+    static const int MAX_COUNT = 1000000;
+
+    // where to continue counting, for COUNT
+    struct Position
+    {
+        qint64  m_secs;         // candidate at this position
+        qint64  m_period;
+        int     m_offsetIndex;
+        int     m_numDelivered;
+    };
+
+    RecurrenceIterator( const AppointmentRecurrence &inRecurrence, const DateTime &inDtStart );
+
+    /* Every CHECKPOINT_STEP counted start dates are appended to inoutCheckpoints, the first
+     *  time a walk gets there. The vector is kept by the owner of the recurrence, so the
+     *  next iterator continues from there and a window costs at most CHECKPOINT_STEP steps
+     *  more than its own start dates. */
+    void setCheckpoints( QVector<Position>* inoutCheckpoints );
+    void seekTo( const DateTime &inDt );
+    bool next( DateTime &outDt );
+
+private:
+    static const int CHECKPOINT_STEP = 1024;
+    // counts the current candidate for COUNT, remembers a checkpoint
+    void countCandidate();
+    /* true, if inDt passes the limiting BYxxx rules. Otherwise outSkipSecs is the
+     * first point in time, where the failing rule can match again. */
+    bool matchesByRules( const DateTime &inDt, qint64 &outSkipSecs ) const;
+    qint64 candidateSecs() const;
+    void advance();
+    // moves forward to the first candidate at or after inSecs
+    void jumpTo( const qint64 inSecs );
+    // moves to the next usable candidate and sets m_candidate, false if there is none left
+    bool findCandidate();
+
+    const AppointmentRecurrence &m_recurrence;
+    DateTime        m_dtStart;
+    qint64          m_startSecs;
+    qint64          m_lastSecs;     // UNTIL or a future date
+    qint64          m_baseSecs;     // start of the period DTSTART is in
+    qint64          m_stepSecs;     // INTERVAL periods
+    QVector<int>    m_offsets;      // expanded times within a period, sorted
+    qint64          m_period;       // candidate is m_offsets[m_offsetIndex] in this period
+    int             m_offsetIndex;
+    int             m_numDelivered; // for COUNT
+    DateTime        m_candidate;
+    QVector<Position>*  m_checkpoints;  // nullptr, if not kept
+};
+
+
 struct Event {
     QString     m_uid;              // to find related Appointment
     QString     m_displayText;      // text to show in calendar
@@ -248,7 +318,7 @@ struct Event {
     int         m_userCalendarId;   // set by appointment
     QColor      m_eventColor;       // is set by appointment
 
-    bool operator==(const Event other) const
+    bool operator==(const Event &other) const
     {
         return m_uid == other.m_uid and
                 m_displayText == other.m_displayText and
@@ -257,7 +327,7 @@ struct Event {
                 m_isAlarmEvent == other.m_isAlarmEvent;
     }
 
-    bool operator<(const Event other) const
+    bool operator<(const Event &other) const
     {
         if( m_startDt.date() < other.m_startDt.date() )
             return true;
@@ -289,6 +359,16 @@ struct Event {
 };
 
 
+/* busy period published by a VFREEBUSY, in seconds since epoch, end excluded.
+ *  Imported ones belong to calendar 0 like imported appointments. */
+struct FreeBusyPeriod
+{
+    int         m_userCalendarId;
+    qint64      m_startSecs;
+    qint64      m_endSecs;
+};
+
+
 class Appointment : public QObject
 {
 
@@ -303,6 +383,10 @@ public:
      * Especially, no sub-apoitments and nothing, a makeEvents() would generate */
     bool isPartiallyEqual( const Appointment &other ) const;
 
+    /* hash over everything, which is stored in database except the events, as they
+     *  are generated from this. Same hash, same appointment. */
+    QByteArray contentHash() const;
+
     // creates a possible unique UID
     void generateUid();
 
@@ -322,6 +406,17 @@ public:
 
     void setEventColor( const QColor inEventColor );
 
+    /* Sub-daily recurrences have no event list, their events are made on request.
+     * appendStreamedEvents() appends all events touching inFirst ... inLast, but at
+     *  most inMaxEventsPerDay starting on the same day. */
+    bool isStreamed() const;
+    void appendStreamedEvents( const QDate &inFirst, const QDate &inLast,
+                               const int inMaxEventsPerDay, QVector<Event> &outEvents ) const;
+
+    /* start dates of all occurrences within inFirst ... inLast, ascending. This works
+     *  without an event list, see AlarmScheduler. */
+    void occurrenceStarts( const DateTime &inFirst, const DateTime &inLast, QVector<DateTime> &outStarts ) const;
+
     AppointmentBasics*          m_appBasics;
     AppointmentRecurrence*      m_appRecurrence;
     QVector<AppointmentAlarm*>  m_appAlarms;
@@ -331,6 +426,7 @@ public:
     int                         m_maxYear;          // end of last event
     // events
     QVector<Event>              m_eventVector;
+    QColor                      m_eventColor;       // also for streamed events
     // calendar id
     int                         m_userCalendarId;
     QString                     m_uid;
@@ -342,10 +438,20 @@ private:
     // helper for makeEvents()
     void makeSingleEvent(); // no recurrences or RDATE
     void makeRDateEvents( const RecurringFixedIntervals &inInterval ); // just RDATE
-    void makeRruleEvents( const DateTime inStartDate, qint64 inDeltaSeconds ); // for RRULE
+    void makeRruleEvents( const DateTime &inStartDate, qint64 inDeltaSeconds ); // for RRULE
+    void makeStreamedYears();   // sub-daily RRULE, just the years
+
+    // sub-daily RRULE with COUNT, positions for the next RecurrenceIterator
+    mutable QVector<RecurrenceIterator::Position>   m_streamCheckpoints;
+
+    // occurrenceStarts(): daily and longer RRULE with COUNT, all start dates
+    mutable QVector<DateTime>   m_countedStarts;
+    mutable bool                m_haveCountedStarts;
+    // occurrenceStarts(): where to start the expansion of a RRULE without COUNT
+    DateTime windowStart( const DateTime &inDtStart, const DateTime &inFirst ) const;
 
     // true, if we have an event in 'm_eventVector' which starts with 'inStartDate'
-    bool eventVectorContainsStartdate(const DateTime inStartDate ) const;
+    bool eventVectorContainsStartdate(const DateTime &inStartDate ) const;
 
     // sorts events, then removes duplicates
     void sortAndRemoveEventDuplicates();
@@ -0,0 +1,62 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "appointmentqueue.h"
+
+#include <QMutexLocker>
+
+
+AppointmentQueue::AppointmentQueue( const int inCapacity )
+    :
+      m_capacity( inCapacity > 0 ? inCapacity : 1 ),
+      m_closed( false )
+{
+}
+
+
+bool AppointmentQueue::push( Appointment* inApp )
+{
+    QMutexLocker locker( &m_mutex );
+    while( m_queue.count() >= m_capacity and not m_closed )
+        m_notFull.wait( &m_mutex );
+    if( m_closed )
+        return false;
+    m_queue.enqueue( inApp );
+    m_notEmpty.wakeOne();
+    return true;
+}
+
+
+int AppointmentQueue::popBatch( QVector<Appointment*> &outApps, const int inMaxCount )
+{
+    outApps.clear();
+    QMutexLocker locker( &m_mutex );
+    while( m_queue.isEmpty() and not m_closed )
+        m_notEmpty.wait( &m_mutex );
+    while( not m_queue.isEmpty() and outApps.count() < inMaxCount )
+        outApps.append( m_queue.dequeue() );
+    m_notFull.wakeAll();
+    return outApps.count();
+}
+
+
+void AppointmentQueue::close()
+{
+    QMutexLocker locker( &m_mutex );
+    m_closed = true;
+    m_notEmpty.wakeAll();
+    m_notFull.wakeAll();
+}
@@ -0,0 +1,58 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef APPOINTMENTQUEUE_H
+#define APPOINTMENTQUEUE_H
+
+#include <QMutex>
+#include <QQueue>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "appointmentmanager.h"
+
+
+/* A bounded, thread safe queue of appointments, which connects the stages of the ical import:
+ *  IcalImportThreads parse, interpret and expand a file and push() the appointments,
+ *  ImportStorageThread pops them in batches and stores them.
+ * push() blocks while the queue is full, so a huge file can not run away from the database
+ *  and the number of appointments in flight stays bounded.
+ * popBatch() blocks while the queue is empty, until close() tells, there are no more producers.
+ */
+class AppointmentQueue
+{
+public:
+    explicit AppointmentQueue( const int inCapacity = 256 );
+
+    // false, if the queue is closed. In this case, the caller still owns inApp
+    bool push( Appointment* inApp );
+
+    // get up to inMaxCount appointments, returns 0 if the queue is closed and empty
+    int popBatch( QVector<Appointment*> &outApps, const int inMaxCount );
+
+    // no more appointments will be pushed
+    void close();
+
+private:
+    QMutex                  m_mutex;
+    QWaitCondition          m_notEmpty;
+    QWaitCondition          m_notFull;
+    QQueue<Appointment*>    m_queue;
+    const int               m_capacity;
+    bool                    m_closed;
+};
+
+#endif // APPOINTMENTQUEUE_H
@@ -17,6 +17,12 @@
 #include "calendarscene.h"
 #include <QDebug>
 
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
 
 
 CalendarScene::CalendarScene(const SettingsData & settings, QObject *parent) :
@@ -98,15 +104,62 @@ CalendarScene::~CalendarScene()
 }
 
 
+/* Give the items the dates firstDate, firstDate + 1, ... in this order.
+ * Items, which already show one of the new dates, just move to its position, so paging
+ * forward one week touches only the days, which are new in the view.
+ * If force is set, all items are re-dated, e.g. for a new week start day. */
+template<class ItemType>
+void CalendarScene::redateItems(QVector<ItemType*> &items, const QDate &firstDate, const bool force)
+{
+    const int count = items.count();
+    if(force)
+    {
+        for(int i = 0; i < count; i++)
+            items[i]->setDate(firstDate.addDays(i));
+        return;
+    }
+
+    QVector<QPointF> positions(count);
+    QVector<ItemType*> newOrder(count, nullptr);
+    QVector<ItemType*> unusedItems;
+    for(int i = 0; i < count; i++)
+    {
+        ItemType* itm = items[i];
+        positions[i] = itm->pos();
+        qint64 index = firstDate.daysTo(itm->date());
+        if(index >= 0 and index < count and newOrder[index] == nullptr)
+            newOrder[index] = itm;
+        else
+            unusedItems.append(itm);
+    }
+    for(int i = 0; i < count; i++)
+    {
+        ItemType* itm = newOrder[i];
+        if(itm == nullptr)
+        {
+            itm = unusedItems.takeLast();
+            itm->setDate(firstDate.addDays(i));
+            newOrder[i] = itm;
+        }
+        if(itm->pos() != positions[i])
+            itm->setPos(positions[i]);
+    }
+    items = newOrder;
+}
+
+
 void CalendarScene::setDate(const QDate & date, bool update)
 {
+    // after midnight, items, which only move, would keep the highlight of yesterday
+    if(DayItem::dayLabelsToday() != QDate::currentDate())
+        update = true;
     if((date == m_currentBaseDate) and (! update))
         return;
 
     int deltaDays;
 
     // Year items
-    if(date.year() != m_currentBaseDate.year())
+    if(update or date.year() != m_currentBaseDate.year())
     {
         for(DayInYearItem* itm : m_daysInYearItems)
         {
@@ -123,7 +176,6 @@ void CalendarScene::setDate(const QDate & date, bool update)
                 }
             }
             itm->setDate(d);
-            itm->update();
         }
     }
 
@@ -133,15 +185,7 @@ void CalendarScene::setDate(const QDate & date, bool update)
     deltaDays = m_weekStartDay - d.dayOfWeek();
     deltaDays = deltaDays > 0 ? deltaDays - 7 : deltaDays;
     d = d.addDays(deltaDays);
-    for(DayInMonthItem* itm : m_daysInMonthItems)
-    {
-        QDate idate = itm->date();
-        idate.setDate(d.year(), d.month(), d.day());
-        itm->setDate(idate);
-        itm->update();
-        d = d.addDays(1);
-    }
-
+    redateItems(m_daysInMonthItems, d, update);
 
     // 3 Weeks items
     d.setDate(date.year(), date.month(), date.day());
@@ -149,28 +193,18 @@ void CalendarScene::setDate(const QDate & date, bool update)
     deltaDays = deltaDays > 0 ? deltaDays - 7 : deltaDays;
     d = d.addDays(deltaDays);
     d = d.addDays(-7);
-    for(DayInMonthItem* itm : m_daysIn3WeeksItems)
-    {
-        itm->setDate(d);
-        itm->update();
-        d = d.addDays(1);
-    }
+    redateItems(m_daysIn3WeeksItems, d, update);
 
     // Week items
     d.setDate(date.year(), date.month(), date.day());
     deltaDays = m_weekStartDay - d.dayOfWeek();
     deltaDays = deltaDays > 0 ? deltaDays - 7 : deltaDays;
     d = d.addDays(deltaDays);
-    for(DayInWeekItem* itm : m_daysInWeekItems)
-    {
-        itm->setDate(d);
-        itm->update();
-        d = d.addDays(1);
-    }
+    redateItems(m_daysInWeekItems, d, update);
 
     // single day item
-    m_dayInDayItem->setDate(date);
-    m_dayInDayItem->update();
+    if(update or date != m_dayInDayItem->date())
+        m_dayInDayItem->setDate(date);
 
     m_currentBaseDate = date;
 }
@@ -297,110 +331,115 @@ void CalendarScene::updateSize(const QSize & newSize)
 }
 
 
-void CalendarScene::setEventsForYear( const QVector<Event> &list )
+/* Greedy slot assignment for events longer than a day: events are taken by start date, each one
+ * goes into the slot which ends first, if that slot ends before the event starts, or into a new slot.
+ * A min-heap of slot end dates makes this O(n log n). Returns the slot number for each event. */
+QVector<int> CalendarScene::rangeSlots(const QVector<Event> &rangeList)
 {
-    for(DayInYearItem* d : m_daysInYearItems)
-        d->removeEvents();
-    if(list.isEmpty())
-        return;
+    const int count = rangeList.count();
+    QVector<int> order(count);
+    for(int i = 0; i < count; i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&rangeList](const int a, const int b)
+                     { return rangeList[a].m_startDt.date() < rangeList[b].m_startDt.date(); });
+
+    // (julian day of the end date, slot number), the slot ending first on top
+    typedef std::pair<qint64, int> SlotEnd;
+    std::priority_queue<SlotEnd, std::vector<SlotEnd>, std::greater<SlotEnd>> slotEnds;
+    QVector<int> slotOf(count, -1);
+    int numSlots = 0;
+    for(const int i : order)
+    {
+        const Event & e = rangeList[i];
+        int slotNum;
+        if(not slotEnds.empty() and slotEnds.top().first < e.m_startDt.date().toJulianDay())
+        {
+            slotNum = slotEnds.top().second;
+            slotEnds.pop();
+        }
+        else
+            slotNum = numSlots++;
+        slotOf[i] = slotNum;
+        slotEnds.push(SlotEnd(e.m_endDt.date().toJulianDay(), slotNum));
+    }
+    return slotOf;
+}
+
+
+/* One pass over all events, each event goes into the bucket of every day it covers.
+ * buckets[0] belongs to firstDate, the following buckets to the following days. */
+void CalendarScene::fillDayBuckets(const QVector<Event> &list, const QDate &firstDate, QVector<DayEvents> &buckets)
+{
+    const qint64 numDays = buckets.count();
     QVector<Event> rangeItemList;
-    QVector<Event> dayItemList;
 
     // dispatch all appointments to a day and a range list
-    for(Event e : list)
+    for(const Event & e : list)
     {
-        if( e.sameDay() )
-            dayItemList.append(e);
+        if(e.sameDay())
+        {
+            qint64 index = firstDate.daysTo(e.m_startDt.date());
+            if(index >= 0 and index < numDays)
+                buckets[index].m_dayEvents.append(e);
+        }
         else
             rangeItemList.append(e);
     }
+    if(rangeItemList.isEmpty())
+        return;
 
-    // day items to the day
-    if(! dayItemList.isEmpty())
-        for(DayInYearItem* d : m_daysInYearItems)
-            d->setAppointmentDaySlots(dayItemList);
+    // range items in slot order, so every bucket gets ascending slots
+    QVector<int> slotOf = rangeSlots(rangeItemList);
+    QVector<int> order(rangeItemList.count());
+    for(int i = 0; i < order.count(); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&slotOf](const int a, const int b) { return slotOf[a] < slotOf[b]; });
 
-    // range items
-    QVector<Event> currentSlotItemList; // list for current slot number
-    int slotNum = 0;
-    QDate endDate;
-    while( ! rangeItemList.isEmpty())
+    for(const int i : order)
     {
-        currentSlotItemList.append(rangeItemList[0]);
-        endDate = rangeItemList[0].m_endDt.date();
-        rangeItemList.removeAt(0);
-
-        // find out the items, which could match into the same slot
-        // they must not overlap
-        for(const Event e : rangeItemList)
-        {
-            if(e.m_startDt.date() > endDate)
-            {
-                currentSlotItemList.append(e);
-                endDate = e.m_endDt.date();
-                rangeItemList.removeOne(e);
-            }
-        }
-
-        // send days the events with a given slot
-        for(DayInYearItem* d : m_daysInYearItems)
-            d->setAppointmentRangeSlot(slotNum, currentSlotItemList);
-        currentSlotItemList.clear();
-        slotNum++;
+        const Event & e = rangeItemList[i];
+        qint64 first = qMax(qint64(0), firstDate.daysTo(e.m_startDt.date()));
+        qint64 last = qMin(numDays - 1, firstDate.daysTo(e.m_endDt.date()));
+        for(qint64 day = first; day <= last; day++)
+            buckets[day].m_rangeEvents.append(qMakePair(slotOf[i], e));
     }
 }
 
 
-void CalendarScene::setEventsForMonth(const QVector<Event> &list)
+void CalendarScene::setEventsForYear( const QVector<Event> &list )
 {
-    for(DayInMonthItem* d : m_daysInMonthItems)
+    for(DayInYearItem* d : m_daysInYearItems)
         d->removeEvents();
     if(list.isEmpty())
         return;
-    QVector<Event> rangeItemList;
-    QVector<Event> dayItemList;
-    QVector<Event> allDayList;
 
-    // dispatch all appointments to day and a range lists
-    for(Event e : list)
-    {
-        if(e.sameDay())
-            dayItemList.append(e);
-        else
-            rangeItemList.append(e);
-    }
+    QDate firstDate(m_currentBaseDate.year(), 1, 1);
+    QVector<DayEvents> buckets(firstDate.daysInYear());
+    fillDayBuckets(list, firstDate, buckets);
 
-    // range items
-    QVector<Event> currentSlotItemList;
-    int slotNum = 0;
-    QDate endDate;
-    while( ! rangeItemList.isEmpty())
+    // items are ordered by month, not by day of year. Invalid dates (29. feb) get nothing.
+    for(DayInYearItem* d : m_daysInYearItems)
     {
-        currentSlotItemList.append(rangeItemList[0]);
-        endDate = rangeItemList[0].m_endDt.date();
-        rangeItemList.removeAt(0);
-
-        for(const Event e : rangeItemList)
-        {
-            if(e.m_startDt.date() > endDate)
-            {
-                currentSlotItemList.append(e);
-                endDate = e.m_endDt.date();
-                rangeItemList.removeOne(e);
-            }
-        }
-        for(DayInMonthItem* d : m_daysInMonthItems)
-            d->setAppointmentRangeSlot(slotNum, currentSlotItemList, m_weekStartDay);
-        currentSlotItemList.clear();
-        slotNum++;
+        if(! d->date().isValid())
+            continue;
+        qint64 index = firstDate.daysTo(d->date());
+        if(index >= 0 and index < buckets.count())
+            d->setDayEvents(buckets[index]);
     }
+}
 
-    // all-day and same-day items
+
+void CalendarScene::setEventsForMonth(const QVector<Event> &list)
+{
     for(DayInMonthItem* d : m_daysInMonthItems)
-    {
-        d->setAppointments(allDayList);
-        d->setAppointments(dayItemList);
-    }
+        d->removeEvents();
+    if(list.isEmpty())
+        return;
+
+    QVector<DayEvents> buckets(m_daysInMonthItems.count());
+    fillDayBuckets(list, m_daysInMonthItems[0]->date(), buckets);
+    for(int i = 0; i < m_daysInMonthItems.count(); i++)
+        m_daysInMonthItems[i]->setDayEvents(buckets[i], m_weekStartDay);
 }
 
 
@@ -410,50 +449,11 @@ void CalendarScene::setEventsFor3Weeks(const QVector<Event> &list)
         d->removeEvents();
     if(list.isEmpty())
         return;
-    QVector<Event> rangeItemList;
-    QVector<Event> dayItemList;
-    QVector<Event> allDayItemList;
-
-    // dispatch all appointments to day and a range lists
-    for(Event e: list)
-    {
-        if( e.sameDay() )
-            dayItemList.append( e );
-        else
-            rangeItemList.append( e );
-    }
-
-    // range items
-    QVector<Event> currentSlotItemList;
-    int slotNum = 0;
-    QDate endDate;
-    while( ! rangeItemList.isEmpty())
-    {
-        currentSlotItemList.append(rangeItemList[0]);
-        endDate = rangeItemList[0].m_endDt.date();
-        rangeItemList.removeAt(0);
 
-        for(const Event e : rangeItemList)
-        {
-            if(e.m_startDt.date() > endDate)
-            {
-                currentSlotItemList.append(e);
-                endDate = e.m_endDt.date();
-                rangeItemList.removeOne(e);
-            }
-        }
-        for(DayInMonthItem* d : m_daysIn3WeeksItems)
-            d->setAppointmentRangeSlot(slotNum, currentSlotItemList, m_weekStartDay);
-        currentSlotItemList.clear();
-        slotNum++;
-    }
-
-    // all-day and same-day items
-    for(DayInMonthItem* d : m_daysIn3WeeksItems)
-    {
-        d->setAppointments(allDayItemList);
-        d->setAppointments(dayItemList);
-    }
+    QVector<DayEvents> buckets(m_daysIn3WeeksItems.count());
+    fillDayBuckets(list, m_daysIn3WeeksItems[0]->date(), buckets);
+    for(int i = 0; i < m_daysIn3WeeksItems.count(); i++)
+        m_daysIn3WeeksItems[i]->setDayEvents(buckets[i], m_weekStartDay);
 }
 
 
@@ -464,50 +464,10 @@ void CalendarScene::setEventsForWeek(const QVector<Event> & list)
     if(list.isEmpty())
         return;
 
-    QVector<Event> rangeItemList;
-    QVector<Event> dayItemList;
-    QVector<Event> allDayItemList;
-
-    // dispatch all appointments to day and a range lists
-    for(Event e : list)
-    {
-        if( e.sameDay() )
-            dayItemList.append( e );
-        else
-            rangeItemList.append( e );
-    }
-
-    // range items
-    QVector<Event> currentSlotItemList;
-    int slotNum = 0;
-    QDate endDate;
-    while( ! rangeItemList.isEmpty())
-    {
-        currentSlotItemList.append(rangeItemList[0]);
-        endDate = rangeItemList[0].m_endDt.date();
-        rangeItemList.removeAt(0);
-
-        for(const Event e : rangeItemList)
-        {
-            if(e.m_startDt.date() > endDate)
-            {
-                currentSlotItemList.append(e);
-                endDate = e.m_endDt.date();
-                rangeItemList.removeOne(e);
-            }
-        }
-        for(DayInWeekItem* d : m_daysInWeekItems)
-            d->setAppointmentRangeSlot(slotNum, currentSlotItemList, m_weekStartDay);
-        currentSlotItemList.clear();
-        slotNum++;
-    }
-
-    // all-day and same-day items
-    for(DayInWeekItem* d : m_daysInWeekItems)
-    {
-        d->setAppointments(allDayItemList);
-        d->setAppointments(dayItemList);
-    }
+    QVector<DayEvents> buckets(m_daysInWeekItems.count());
+    fillDayBuckets(list, m_daysInWeekItems[0]->date(), buckets);
+    for(int i = 0; i < m_daysInWeekItems.count(); i++)
+        m_daysInWeekItems[i]->setDayEvents(buckets[i], m_weekStartDay);
 }
 
 
@@ -520,7 +480,7 @@ void CalendarScene::setEventsForDay(const QVector<Event> &list)
     QVector<Event> partDayList;
 
     // dispatch all appointments to fullDay and part-time-list.
-    for(Event e : list)
+    for(const Event &e : list)
     {
         if(e.m_startDt.date() < m_currentBaseDate and e.m_endDt.date() > m_currentBaseDate)
             fullDayList.append(e);
@@ -561,6 +521,19 @@ void CalendarScene::removeEventsById( const QString appointmentId )
 }
 
 
+void CalendarScene::reconfigureAppointment(const QString appointmentId)
+{
+    emit signalReconfigureAppointment(appointmentId);
+}
+
+
+/* deletion removes the EventItem asking for it, MainWindow receives the signal queued. */
+void CalendarScene::deleteAppointment(const QString appointmentId)
+{
+    emit signalDeleteAppointment(appointmentId);
+}
+
+
 void CalendarScene::setSettings(const SettingsData & settings)
 {
     m_weekStartDay = settings.m_weekStartDay;   // local copy
@@ -576,6 +549,14 @@ void CalendarScene::setSettings(const SettingsData & settings)
 
     m_dayInDayItem->setActiveDaytime(settings.m_dayStartHour, settings.m_dayEndHour);
 
+    // opt-in pixmap cache for the many small days
+    for(DayInYearItem* d : m_daysInYearItems)
+        d->setRasterCache(settings.m_useDayRasterCache);
+    for(DayInMonthItem* d : m_daysInMonthItems)
+        d->setRasterCache(settings.m_useDayRasterCache);
+    for(DayInMonthItem* d : m_daysIn3WeeksItems)
+        d->setRasterCache(settings.m_useDayRasterCache);
+
     // update
     setDate(m_currentBaseDate, true);
 }
@@ -634,8 +615,6 @@ void CalendarScene::createDays()
             QDate d = QDate::currentDate();
             d.setDate(d.year(), i + 1, k + 1);
             DayInYearItem *tmp = new DayInYearItem(d);
-            connect(tmp, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-            connect(tmp, SIGNAL(signalDeleteAppointment(QString)), this, SIGNAL(signalDeleteAppointment(QString)));
             connect(tmp, SIGNAL(signalDateClicked(QDate)), this, SIGNAL(signalDateClicked(QDate)));
             tmp->setPos(x0, (k + 1) * 20);
             tmp->hide();
@@ -655,8 +634,6 @@ void CalendarScene::createDays()
         for(int day = 0; day < 7; day++)
         {
             DayInMonthItem *tmp = new DayInMonthItem(d);
-            connect(tmp, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-            connect(tmp, SIGNAL(signalDeleteAppointment(QString)), this, SIGNAL(signalDeleteAppointment(QString)));
             connect(tmp, SIGNAL(signalDateClicked(QDate)), this, SIGNAL(signalDateClicked(QDate)));
             tmp->setPos(x0, y0);
             x0 += 100;
@@ -675,8 +652,6 @@ void CalendarScene::createDays()
     for(int day = 0; day < 21; day++)
     {
         DayInMonthItem *tmp = new DayInMonthItem(d);
-        connect(tmp, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-        connect(tmp, SIGNAL(signalDeleteAppointment(QString)), this, SIGNAL(signalDeleteAppointment(QString)));
         connect(tmp, SIGNAL(signalDateClicked(QDate)), this, SIGNAL(signalDateClicked(QDate)));
         tmp->hide();
         addItem(tmp);
@@ -690,8 +665,6 @@ void CalendarScene::createDays()
     for(int day = 0; day < 7; day++)
     {
         DayInWeekItem *tmp = new DayInWeekItem(d);
-        connect(tmp, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-        connect(tmp, SIGNAL(signalDeleteAppointment(QString)), this, SIGNAL(signalDeleteAppointment(QString)));
         connect(tmp, SIGNAL(signalDateClicked(QDate)), this, SIGNAL(signalDateClicked(QDate)));
         tmp->hide();
         addItem(tmp);
@@ -701,8 +674,6 @@ void CalendarScene::createDays()
 
     // single day
     m_dayInDayItem = new DayInDayItem(QDate::currentDate());
-    connect(m_dayInDayItem, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-    connect(m_dayInDayItem, SIGNAL(signalDeleteAppointment(QString)), this, SIGNAL(signalDeleteAppointment(QString)));
     connect(m_dayInDayItem, SIGNAL(signalDateClicked(QDate)), this, SIGNAL(signalDateClicked(QDate)));
     m_dayInDayItem->hide();
     addItem(m_dayInDayItem);
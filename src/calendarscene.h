@@ -56,6 +56,9 @@ public:
 
     void removeAllEvents();
     void removeEventsById( const QString appointmentId );
+    // actions of EventItems, MainWindow gets them by the signals below
+    void reconfigureAppointment(const QString appointmentId);
+    void deleteAppointment(const QString appointmentId);
     void setSettings(const SettingsData & settings);
 
     void eventsHaveNewColor(const int inUsercalendarID, const QColor inCalendarColor );
@@ -82,6 +85,14 @@ private:
 
     QString m_longestDaylabelTextInYear;
 
+    // dates to days
+    template<class ItemType>
+    void redateItems(QVector<ItemType*> &items, const QDate &firstDate, const bool force);
+
+    // events to days
+    static QVector<int> rangeSlots(const QVector<Event> &rangeList);
+    static void fillDayBuckets(const QVector<Event> &list, const QDate &firstDate, QVector<DayEvents> &buckets);
+
     void hideAllItems();
 
     CalendarShow m_showView;
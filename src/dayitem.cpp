@@ -15,7 +15,9 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 #include "dayitem.h"
+#include "calendarscene.h"
 #include <QDebug>
+#include <QHash>
 
 
 /***********************************************************
@@ -59,44 +61,66 @@ EventItem::EventItem(QGraphicsItem *parent) :
 }
 
 
-EventItem::EventItem(Event event, QGraphicsItem *parent) :
-    QGraphicsObject(parent),
-    m_color(event.m_eventColor),m_userCalendarId(event.m_userCalendarId),
-    m_dummy(false), m_size(3, 3), m_sizeTooSmall(false),
-    m_title(event.m_displayText),
-    m_showTitle(false), m_fontPixelSize(1),
-    m_appointmentId(event.m_uid),
-    m_startDt(event.m_startDt),
-    m_endDt(event.m_endDt), m_allDay(false)
+EventItem::EventItem(const Event & event, QGraphicsItem *parent) :
+    QGraphicsObject(parent), m_size(3, 3)
 {
+    setEvent(event);
+}
+
+
+/* rebind this item to another event, geometry is set by the owner afterwards */
+void EventItem::setEvent(const Event & event)
+{
+    m_color = event.m_eventColor;
+    m_userCalendarId = event.m_userCalendarId;
+    m_dummy = false;
+    m_sizeTooSmall = m_size.width() < 1.0f or m_size.height() < 1.0f;
+    m_title = event.m_displayText;
+    m_showTitle = false;
+    m_fontPixelSize = 1;
+    m_appointmentId = event.m_uid;
+    m_startDt = event.m_startDt;
+    m_endDt = event.m_endDt;
+    m_allDay = false;
+
     QString toolTipText = QString("%1 (cal-id = %2, app-id = %3) - %4 to %5")
             .arg(m_title)
             .arg(m_userCalendarId).arg(m_appointmentId)
             .arg(m_startDt.toString("dd.MM.yy, hh:mm")).arg(m_endDt.toString("dd.MM.yy, hh:mm"));
     setToolTip(toolTipText);
+    setFlag(QGraphicsItem::ItemHasNoContents, false);
     setFlag(QGraphicsItem::ItemIsFocusable, true);
-
-    // context menu
-    m_actionReconfigureAppointment = new QAction("Configure", this);
-    connect(m_actionReconfigureAppointment, SIGNAL(triggered()), this, SLOT(slotPrepareReconfigureAppointment()));
-    m_deleteThisAppointment = new QAction("Delete Appointment", this);
-    connect(m_deleteThisAppointment, SIGNAL(triggered()), this, SLOT(slotPrepareDeleteAppointment()));
-    m_contextMenu.addAction(m_actionReconfigureAppointment);
-    m_contextMenu.addAction(m_deleteThisAppointment);
+    update();
 }
 
 
-EventItem::~EventItem()
+void EventItem::setDummy()
 {
-    delete m_deleteThisAppointment;
-    delete m_actionReconfigureAppointment;
+    m_color = Qt::black;
+    m_dummy = true;
+    prepareGeometryChange();
+    m_size = QSizeF(3, 3);
+    m_sizeTooSmall = true;
+    m_title = "";
+    m_showTitle = false;
+    m_fontPixelSize = 0;
+    m_appointmentId = "";
+    setToolTip(QString());
+    setFlag(QGraphicsItem::ItemIsFocusable, false);
+    setFlag(QGraphicsItem::ItemHasNoContents, true);
 }
 
 
 void EventItem::resize(const qreal width, const qreal height)
 {
     if(m_dummy) return;
-    m_size = QSizeF((int) width, (int) height);
+    QSizeF size((int) width, (int) height);
+    // the scene index keeps the old bounding rect otherwise
+    if(size != m_size)
+    {
+        prepareGeometryChange();
+        m_size = size;
+    }
     m_sizeTooSmall = width < 1.0f or height <1.0f;
     update();
 }
@@ -138,10 +162,10 @@ void EventItem::keyReleaseEvent(QKeyEvent* event)
     switch(event->key())
     {
         case Qt::Key_Return:
-            slotPrepareReconfigureAppointment();
+            prepareReconfigureAppointment();
             break;
         case Qt::Key_Delete:
-            slotPrepareDeleteAppointment();
+            prepareDeleteAppointment();
             break;
         default:
             break;
@@ -152,35 +176,46 @@ void EventItem::keyReleaseEvent(QKeyEvent* event)
 void EventItem::mousePressEvent(QGraphicsSceneMouseEvent* event)
 {
     if(event->button() == Qt::LeftButton)
-        slotPrepareReconfigureAppointment();
+        prepareReconfigureAppointment();
     QGraphicsObject::mousePressEvent(event);
 }
 
 
 void EventItem::contextMenuEvent(QGraphicsSceneContextMenuEvent* event)
 {
-    m_contextMenu.exec(event->screenPos());
+    if(m_dummy)
+        return;
+    QMenu contextMenu;
+    QAction* actionReconfigure = contextMenu.addAction("Configure");
+    QAction* actionDelete = contextMenu.addAction("Delete Appointment");
+    QAction* selected = contextMenu.exec(event->screenPos());
+    if(selected == actionReconfigure)
+        prepareReconfigureAppointment();
+    else if(selected == actionDelete)
+        prepareDeleteAppointment();
 }
 
 
-void EventItem::slotPrepareReconfigureAppointment()
+void EventItem::prepareReconfigureAppointment()
 {
     if(m_appointmentId == "" or m_dummy)
         return;
-    emit signalReconfigureAppointment(m_appointmentId);
+    CalendarScene* calendarScene = qobject_cast<CalendarScene*>(scene());
+    if(calendarScene)
+        calendarScene->reconfigureAppointment(m_appointmentId);
 }
 
 
-void EventItem::slotPrepareDeleteAppointment()
+void EventItem::prepareDeleteAppointment()
 {
     // dont't do too much here, because the user may
     // reject deletition by a dialog: "Do you really want to delete..."
     if(m_appointmentId == "" or m_dummy)
         return;
-    // this is possibly fragile, as this causes the deletion of "this"
-    // during execution. Qt::QueuedConnection is fine.
-    QMetaObject::invokeMethod(this, "signalDeleteAppointment", Qt::QueuedConnection, Q_ARG(QString, m_appointmentId) );
-
+    // deletion removes "this", see CalendarScene::deleteAppointment()
+    CalendarScene* calendarScene = qobject_cast<CalendarScene*>(scene());
+    if(calendarScene)
+        calendarScene->deleteAppointment(m_appointmentId);
 }
 
 
@@ -204,24 +239,71 @@ DayItem::~DayItem()
 
 void DayItem::resize(const qreal width, const qreal height)
 {
+    prepareGeometryChange();
     m_size = QSizeF(width, height);
 }
 
 
+/* All DayItems ask for the same few texts and box sizes on every resize, so
+ * results are shared between all items. Cleared, if it grows too large. */
+namespace
+{
+    struct FontFitKey
+    {
+        QString fontKey;
+        QString text;
+        int width;
+        int height;
+        bool operator==(const FontFitKey & other) const
+        {
+            return width == other.width and height == other.height and
+                    text == other.text and fontKey == other.fontKey;
+        }
+    };
+
+    uint qHash(const FontFitKey & key, uint seed = 0)
+    {
+        return ::qHash(key.text, seed) ^ ::qHash(key.fontKey, seed) ^ uint(key.width * 4099 + key.height);
+    }
+
+    const int FONT_FIT_CACHE_MAX = 512;
+    QHash<FontFitKey, int> s_fontFitCache;
+}
+
+
+/* largest pixel size <= height, where text fits into width. Binary search, as
+ * metrics width is growing with the pixel size. */
 int DayItem::perfectFontSizeForString(const QString & text, const int width, const int height) const
 {
     QFont f = m_dayLabel->font();
     f.setWeight(QFont::Normal);
-    int s = height;
-    while(s > 1)
+    f.setPixelSize(1);
+    FontFitKey key { f.key(), text, width, height };
+    QHash<FontFitKey, int>::const_iterator it = s_fontFitCache.constFind(key);
+    if(it != s_fontFitCache.constEnd())
+        return it.value();
+
+    int best = 1;
+    int low = 2;
+    int high = height;
+    while(low <= high)
     {
+        int s = (low + high) / 2;
         f.setPixelSize(s);
         QFontMetrics metrics1 = QFontMetrics(f);
         if(metrics1.width(text) <= width)
-            return s;
-        s--;
+        {
+            best = s;
+            low = s + 1;
+        }
+        else
+            high = s - 1;
     }
-    return 1;
+
+    if(s_fontFitCache.count() >= FONT_FIT_CACHE_MAX)
+        s_fontFitCache.clear();
+    s_fontFitCache.insert(key, best);
+    return best;
 }
 
 
@@ -233,38 +315,88 @@ void DayItem::setFontPixelSize(const int size)
 }
 
 
+/* Texts and colors of all days of a year, computed once per year. Styles depend on
+ * today, so the table is rebuilt, when the date changes. */
+namespace
+{
+    const int DAY_LABEL_MAX_YEARS = 8;
+    QDate s_dayLabelsToday;
+    QHash<int, QVector<DayLabel>> s_dayLabels;
+
+    QVector<DayLabel> createDayLabels(const int year, const QDate & today)
+    {
+        QDate date(year, 1, 1);
+        QVector<DayLabel> labels(date.daysInYear());
+        for(DayLabel & label : labels)
+        {
+            bool weekend = date.dayOfWeek() > 5;
+            label.m_shortText = date.toString("dd");
+            label.m_yearText = date.toString("dd ddd");
+            if(date.day() == 1 or date.dayOfWeek() == 1)
+                label.m_weekNumberText = QString("%1").arg(date.weekNumber(), 2);
+            label.m_bold = date == today;
+            if(today.year() == date.year() and today.month() == date.month())
+            {
+                if(label.m_bold)
+                    label.m_color = weekend ? Qt::red : Qt::blue;
+                else
+                    label.m_color = weekend ? Qt::red : Qt::darkBlue;
+            }
+            else
+                label.m_color = weekend ? Qt::darkRed : Qt::black;
+            date = date.addDays(1);
+        }
+        return labels;
+    }
+}
+
+
+const DayLabel & DayItem::dayLabel(const QDate & date)
+{
+    static const DayLabel invalidLabel { QString(), QString(), QString(), Qt::black, false };
+    if(! date.isValid())
+        return invalidLabel;
+
+    QDate today = QDate::currentDate();
+    if(today != s_dayLabelsToday)
+    {
+        s_dayLabels.clear();
+        s_dayLabelsToday = today;
+    }
+    QHash<int, QVector<DayLabel>>::iterator it = s_dayLabels.find(date.year());
+    if(it == s_dayLabels.end())
+    {
+        if(s_dayLabels.count() >= DAY_LABEL_MAX_YEARS)
+            s_dayLabels.clear();
+        it = s_dayLabels.insert(date.year(), createDayLabels(date.year(), today));
+    }
+    return it.value()[date.dayOfYear() - 1];
+}
+
+
+QDate DayItem::dayLabelsToday()
+{
+    return s_dayLabelsToday;
+}
+
+
 void DayItem::setDate(const QDate date)
 {
     m_displayDate = date;
+    update();   // paint() depends on the date, invalidates the raster cache too
     if(! date.isValid())
     {
         return;
     }
-    QDate cDate = QDate::currentDate();
+    const DayLabel & label = dayLabel(date);
     QFont font = m_dayLabel->font();
-    bool weekend = date.dayOfWeek() > 5;
-
-    if(cDate.year() == date.year() and cDate.month() == date.month())
-    {
-        if(cDate.day() == date.day())
-        {
-            font.setWeight(QFont::Bold);
-            m_dayLabel->setFont(font);
-            m_dayLabel->setBrush(weekend ? Qt::red : Qt::blue);
-        }
-        else
-        {
-            font.setWeight(QFont::Normal);
-            m_dayLabel->setFont(font);
-            m_dayLabel->setBrush(weekend ? Qt::red : Qt::darkBlue);
-        }
-    }
-    else
+    int weight = label.m_bold ? QFont::Bold : QFont::Normal;
+    if(font.weight() != weight)
     {
-        font.setWeight(QFont::Normal);
+        font.setWeight(weight);
         m_dayLabel->setFont(font);
-        m_dayLabel->setBrush(weekend ? Qt::darkRed : Qt::black);
     }
+    m_dayLabel->setBrush(label.m_color);
 }
 
 
@@ -274,15 +406,58 @@ void DayItem::setDayText(const QString dayString)
 }
 
 
+/* Keep the painting of this day and its labels and events as a pixmap, which is
+ * redrawn only, if the date, the events or the size change. */
+void DayItem::setRasterCache(const bool enable)
+{
+    QGraphicsItem::CacheMode mode = enable ? QGraphicsItem::DeviceCoordinateCache : QGraphicsItem::NoCache;
+    setCacheMode(mode);
+    for(QGraphicsItem* child : childItems())
+        child->setCacheMode(mode);
+}
+
+
 void DayItem::mouseDoubleClickEvent(QGraphicsSceneMouseEvent*)
 {
     emit signalDateClicked(m_displayDate);
 }
 
 
-void DayItem::slotDeleteAppointment(QString appointmentId)
+EventItem* DayItem::newEventItem(const Event & event)
+{
+    if(m_spareEventItems.isEmpty())
+    {
+        EventItem* itm = new EventItem(event, this);
+        itm->setCacheMode(cacheMode());
+        return itm;
+    }
+    EventItem* itm = m_spareEventItems.takeLast();
+    itm->setEvent(event);
+    itm->show();
+    return itm;
+}
+
+
+EventItem* DayItem::newDummyEventItem()
 {
-    emit signalDeleteAppointment(appointmentId);
+    if(m_spareEventItems.isEmpty())
+    {
+        EventItem* itm = new EventItem(this);   // dummy item
+        itm->setCacheMode(cacheMode());
+        return itm;
+    }
+    EventItem* itm = m_spareEventItems.takeLast();
+    itm->setDummy();
+    itm->show();
+    return itm;
+}
+
+
+void DayItem::releaseEventItem(EventItem* itm)
+{
+    itm->clearFocus();
+    itm->hide();
+    m_spareEventItems.append(itm);
 }
 
 
@@ -414,13 +589,12 @@ void DayInYearItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QW
 
 void DayInYearItem::setDate(const QDate date)
 {
-    QString displayDay = date.toString("dd ddd");
-    setDayText(displayDay);
     DayItem::setDate(date);
-    if(date.day() == 1 or date.dayOfWeek() == 1)
+    const DayLabel & label = dayLabel(date);
+    setDayText(label.m_yearText);
+    if(not label.m_weekNumberText.isEmpty())
     {
-        QString displayWeekNumber = QString("%1").arg(date.weekNumber(), 2);
-        m_weekNumberLabel->setText(displayWeekNumber);
+        m_weekNumberLabel->setText(label.m_weekNumberText);
         m_weekNumberLabel->show();
         adjustSubitemPositions();
     }
@@ -429,42 +603,26 @@ void DayInYearItem::setDate(const QDate date)
 }
 
 
-void DayInYearItem::setAppointmentDaySlots(const QVector<Event> &list)
+void DayInYearItem::setDayEvents(const DayEvents & events)
 {
     if( ! date().isValid() ) return;
-    for(Event e : list)
+    for(const QPair<int, Event> & slotEvent : events.m_rangeEvents)
     {
-        if( e.containsDay(date()) )
+        // fill gaps with dummies up to the slot
+        while(slotEvent.first > m_appointmentSlotsRange.count())
         {
-            EventItem* itm = new EventItem(e, this);
-            connect(itm, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-            connect(itm, SIGNAL(signalDeleteAppointment(QString)), this, SLOT(slotDeleteAppointment(QString)));
-            itm->setShowTitle(false);
-            m_appointmentSlotsDay.append(itm);
+            EventItem* itm = newDummyEventItem();
+            m_appointmentSlotsRange.append(itm);
         }
+        EventItem* itm = newEventItem(slotEvent.second);
+        itm->setShowTitle(false);
+        m_appointmentSlotsRange.append(itm);
     }
-    adjustSubitemPositions();
-}
-
-
-void DayInYearItem::setAppointmentRangeSlot(const int slot, const QVector<Event> &list)
-{
-    if( ! date().isValid() ) return;
-    for(Event e : list)
+    for(const Event & e : events.m_dayEvents)
     {
-        if( e.containsDay(date()) )
-        {
-            while(slot > m_appointmentSlotsRange.count())
-            {
-                EventItem* itm = new EventItem(this);
-                m_appointmentSlotsRange.append(itm);
-            }
-            EventItem* itm = new EventItem(e, this);
-            connect(itm, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-            connect(itm, SIGNAL(signalDeleteAppointment(QString)), this, SLOT(slotDeleteAppointment(QString)));
-            itm->setShowTitle(false);
-            m_appointmentSlotsRange.append(itm);
-        }
+        EventItem* itm = newEventItem(e);
+        itm->setShowTitle(false);
+        m_appointmentSlotsDay.append(itm);
     }
     adjustSubitemPositions();
 }
@@ -473,9 +631,9 @@ void DayInYearItem::setAppointmentRangeSlot(const int slot, const QVector<Event>
 void DayInYearItem::removeEvents()
 {
     while( not m_appointmentSlotsDay.isEmpty() )
-        delete m_appointmentSlotsDay.takeLast();
+        releaseEventItem(m_appointmentSlotsDay.takeLast());
     while( not m_appointmentSlotsRange.isEmpty() )
-        delete m_appointmentSlotsRange.takeLast();
+        releaseEventItem(m_appointmentSlotsRange.takeLast());
 
     m_tooManyItems->hide();
 }
@@ -486,14 +644,12 @@ void DayInYearItem::removeEvents( const QString appointmentId )
     for( int i = 0; i < m_appointmentSlotsDay.count(); i++ )
         if( m_appointmentSlotsDay[i]->appointmentId() == appointmentId )
         {
-            EventItem* itm = m_appointmentSlotsDay.takeAt( i );
-            delete itm;
+            releaseEventItem( m_appointmentSlotsDay.takeAt( i ) );
         }
     for( int i = 0; i < m_appointmentSlotsRange.count(); i++ )
         if( m_appointmentSlotsRange[i]->appointmentId() == appointmentId )
         {
-            EventItem* itm = m_appointmentSlotsRange.takeAt( i );
-            delete itm;
+            releaseEventItem( m_appointmentSlotsRange.takeAt( i ) );
         }
     m_tooManyItems->hide();
 }
@@ -591,66 +747,54 @@ void DayInMonthItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, Q
 
 void DayInMonthItem::setDate(const QDate date)
 {
-    setDayText(date.toString("dd"));
+    setDayText(dayLabel(date).m_shortText);
     DayItem::setDate(date);
 }
 
 
-void DayInMonthItem::setAppointmentRangeSlot(const int slot, const QVector<Event> &list, int weekStart)
+void DayInMonthItem::setDayEvents(const DayEvents & events, const int weekStart)
 {
-    if( (! date().isValid()) or list.isEmpty() ) return;
+    if( ! date().isValid() ) return;
 
-    for(Event e : list)
+    // range items, gaps are filled with dummies
+    for(const QPair<int, Event> & slotEvent : events.m_rangeEvents)
     {
-        if( e.containsDay(date()) )
+        while(slotEvent.first > m_appointmentSlots.count())
         {
-            while(slot > m_appointmentSlots.count())
-            {
-                EventItem* dummyItem = new EventItem(this);
-                m_appointmentSlots.append(dummyItem);
-            }
-
-            EventItem* itm = new EventItem(e, this);
-            connect(itm, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-            connect(itm, SIGNAL(signalDeleteAppointment(QString)), this, SLOT(slotDeleteAppointment(QString)));
-            bool showTitle = (date().dayOfWeek() == weekStart) or
-                    (e.m_startDt.date().day() == date().day() and
-                     e.m_startDt.date().month() == date().month());
-            itm->setShowTitle(showTitle);
-            m_appointmentSlots.append(itm);
+            EventItem* dummyItem = newDummyEventItem();
+            m_appointmentSlots.append(dummyItem);
         }
+        const Event & e = slotEvent.second;
+        EventItem* itm = newEventItem(e);
+        bool showTitle = (date().dayOfWeek() == weekStart) or
+                (e.m_startDt.date().day() == date().day() and
+                 e.m_startDt.date().month() == date().month());
+        itm->setShowTitle(showTitle);
+        m_appointmentSlots.append(itm);
     }
-    adjustSubitemPositions();
-}
-
 
-void DayInMonthItem::setAppointments(const QVector<Event> &list)
-{
-    if( (! date().isValid()) or list.isEmpty() ) return;
-    for(Event e : list)
+    // same-day items
+    for(const Event & e : events.m_dayEvents)
     {
-        if( e.containsDay(date()) )
-        {
-            bool replaced = false;
+        bool replaced = false;
 
-            EventItem* itm = new EventItem(e, this);
-            connect(itm, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-            connect(itm, SIGNAL(signalDeleteAppointment(QString)), this, SLOT(slotDeleteAppointment(QString)));
-            itm->setShowTitle(true);
-
-            //find and replace dummy-item
-            for(int index = 0; index < m_appointmentSlots.count(); index++)
+        //find and rebind dummy-item
+        for(EventItem* dummyItem : m_appointmentSlots)
+        {
+            if(dummyItem->dummy())
             {
-                if(m_appointmentSlots[index]->dummy())
-                {
-                    m_appointmentSlots.replace(index, itm);
-                    replaced = true;
-                    break;
-                }
+                dummyItem->setEvent(e);
+                dummyItem->setShowTitle(true);
+                replaced = true;
+                break;
             }
-            // else append item
-            if(! replaced)
-                m_appointmentSlots.append(itm);
+        }
+        // else append item
+        if(! replaced)
+        {
+            EventItem* itm = newEventItem(e);
+            itm->setShowTitle(true);
+            m_appointmentSlots.append(itm);
         }
     }
     adjustSubitemPositions();
@@ -660,7 +804,7 @@ void DayInMonthItem::setAppointments(const QVector<Event> &list)
 void DayInMonthItem::removeEvents()
 {
     while( not m_appointmentSlots.isEmpty() )
-        delete m_appointmentSlots.takeLast();
+        releaseEventItem(m_appointmentSlots.takeLast());
 }
 
 
@@ -669,8 +813,7 @@ void DayInMonthItem::removeEvents( const QString appointmentId )
     for( int i = 0; i < m_appointmentSlots.count(); i++ )
         if( m_appointmentSlots[i]->appointmentId() == appointmentId )
         {
-            EventItem* itm = m_appointmentSlots.takeAt( i );
-            delete itm;
+            releaseEventItem( m_appointmentSlots.takeAt( i ) );
         }
 
     m_tooManyItems->hide();
@@ -763,66 +906,54 @@ void DayInWeekItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QW
 
 void DayInWeekItem::setDate(const QDate date)
 {
-    setDayText(date.toString("dd"));
+    setDayText(dayLabel(date).m_shortText);
     DayItem::setDate(date);
 }
 
 
-void DayInWeekItem::setAppointmentRangeSlot(const int slot, const QVector<Event> &list, int weekStart)
+void DayInWeekItem::setDayEvents(const DayEvents & events, const int weekStart)
 {
-    if( (! date().isValid()) or list.isEmpty() ) return;
+    if( ! date().isValid() ) return;
 
-    for(Event e : list)
+    // range items, gaps are filled with dummies
+    for(const QPair<int, Event> & slotEvent : events.m_rangeEvents)
     {
-        if( e.containsDay(date()) )
+        while(slotEvent.first > m_appointmentSlots.count())
         {
-            while(slot > m_appointmentSlots.count())
-            {
-                EventItem* dummyItem = new EventItem(this);
-                m_appointmentSlots.append(dummyItem);
-            }
-
-            EventItem* itm = new EventItem(e, this);
-            connect(itm, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-            connect(itm, SIGNAL(signalDeleteAppointment(QString)), this, SLOT(slotDeleteAppointment(QString)));
-            bool showTitle = (date().dayOfWeek() == weekStart) or
-                    (e.m_startDt.date().day() == date().day() and
-                     e.m_startDt.date().month() == date().month());
-            itm->setShowTitle(showTitle);
-            m_appointmentSlots.append(itm);
+            EventItem* dummyItem = newDummyEventItem();
+            m_appointmentSlots.append(dummyItem);
         }
+        const Event & e = slotEvent.second;
+        EventItem* itm = newEventItem(e);
+        bool showTitle = (date().dayOfWeek() == weekStart) or
+                (e.m_startDt.date().day() == date().day() and
+                 e.m_startDt.date().month() == date().month());
+        itm->setShowTitle(showTitle);
+        m_appointmentSlots.append(itm);
     }
-    adjustSubitemPositions();
-}
 
-
-void DayInWeekItem::setAppointments(const QVector<Event> &list)
-{
-    if( (! date().isValid()) or list.isEmpty() ) return;
-    for(Event e : list)
+    // same-day items
+    for(const Event & e : events.m_dayEvents)
     {
-        if( e.containsDay(date()) )
-        {
-            bool replaced = false;
-
-            EventItem* itm = new EventItem(e, this);
-            connect(itm, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-            connect(itm, SIGNAL(signalDeleteAppointment(QString)), this, SLOT(slotDeleteAppointment(QString)));
-            itm->setShowTitle(true);
+        bool replaced = false;
 
-            //find and replace dummy-item
-            for(int index = 0; index < m_appointmentSlots.count(); index++)
+        //find and rebind dummy-item
+        for(EventItem* dummyItem : m_appointmentSlots)
+        {
+            if(dummyItem->dummy())
             {
-                if(m_appointmentSlots[index]->dummy())
-                {
-                    m_appointmentSlots.replace(index, itm);
-                    replaced = true;
-                    break;
-                }
+                dummyItem->setEvent(e);
+                dummyItem->setShowTitle(true);
+                replaced = true;
+                break;
             }
-            // else append item
-            if(! replaced)
-                m_appointmentSlots.append(itm);
+        }
+        // else append item
+        if(! replaced)
+        {
+            EventItem* itm = newEventItem(e);
+            itm->setShowTitle(true);
+            m_appointmentSlots.append(itm);
         }
     }
     adjustSubitemPositions();
@@ -832,7 +963,7 @@ void DayInWeekItem::setAppointments(const QVector<Event> &list)
 void DayInWeekItem::removeEvents()
 {
     while( not m_appointmentSlots.isEmpty() )
-        delete m_appointmentSlots.takeLast();
+        releaseEventItem(m_appointmentSlots.takeLast());
 }
 
 
@@ -841,8 +972,7 @@ void DayInWeekItem::removeEvents( const QString appointmentId )
     for( int i = 0; i < m_appointmentSlots.count(); i++ )
         if( m_appointmentSlots[i]->appointmentId() == appointmentId )
         {
-            EventItem* itm = m_appointmentSlots.takeAt( i );
-            delete itm;
+            releaseEventItem( m_appointmentSlots.takeAt( i ) );
         }
 
     m_tooManyItems->hide();
@@ -1011,7 +1141,7 @@ void DayInDayItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWi
     painter->drawLine(itemRect.topLeft(), itemRect.topRight());
     painter->drawLine(itemRect.topLeft(), itemRect.bottomLeft());
 
-    for(Marker m : m_markerList)
+    for(const Marker &m : m_markerList)
     {
         painter->drawLine(QPointF(0.0f, m.ypos), QPointF(itemRect.right(), m.ypos));
         if(m.hour < 0 or m.hour == 25)
@@ -1024,7 +1154,7 @@ void DayInDayItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWi
 
 void DayInDayItem::setDate(const QDate date)
 {
-    setDayText(date.toString("dd"));
+    setDayText(dayLabel(date).m_shortText);
     DayItem::setDate(date);
 }
 
@@ -1042,11 +1172,9 @@ void DayInDayItem::setActiveDaytime(int hourBegin, int hourEnd)
 void DayInDayItem::setAppointmentsFullDay(const QVector<Event> &list)
 {
     if(list.isEmpty() or (!date().isValid())) return;
-    for(Event e : list)
+    for(const Event &e : list)
     {
-        EventItem* itm = new EventItem(e, this);
-        connect(itm, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-        connect(itm, SIGNAL(signalDeleteAppointment(QString)), this, SLOT(slotDeleteAppointment(QString)));
+        EventItem* itm = newEventItem(e);
         itm->setShowTitle(true);
         m_appointmentFullDay.append(itm);
     }
@@ -1105,11 +1233,9 @@ void DayInDayItem::setAppointmentsPartDay(const QVector<Event> &list)
     }
 
     // create event items
-    for(Event e : sortedList)
+    for(const Event &e : sortedList)
     {
-        EventItem* itm = new EventItem(e, this);
-        connect(itm, SIGNAL(signalReconfigureAppointment(QString)), this, SIGNAL(signalReconfigureAppointment(QString)));
-        connect(itm, SIGNAL(signalDeleteAppointment(QString)), this, SLOT(slotDeleteAppointment(QString)));
+        EventItem* itm = newEventItem(e);
         itm->setShowTitle(true);
         m_appointmentPartDay.append(itm);
     }
@@ -1120,9 +1246,9 @@ void DayInDayItem::setAppointmentsPartDay(const QVector<Event> &list)
 void DayInDayItem::removeEvents()
 {
     while( not m_appointmentFullDay.isEmpty() )
-        delete m_appointmentFullDay.takeLast();
+        releaseEventItem(m_appointmentFullDay.takeLast());
     while( not m_appointmentPartDay.isEmpty() )
-        delete m_appointmentPartDay.takeLast();
+        releaseEventItem(m_appointmentPartDay.takeLast());
 }
 
 
@@ -1131,14 +1257,12 @@ void DayInDayItem::removeEvents( const QString appointmentId )
     for( int i = 0; i < m_appointmentFullDay.count(); i++ )
         if( m_appointmentFullDay[i]->appointmentId() == appointmentId )
         {
-            EventItem* itm = m_appointmentFullDay.takeAt( i );
-            delete itm;
+            releaseEventItem( m_appointmentFullDay.takeAt( i ) );
         }
     for( int i = 0; i < m_appointmentPartDay.count(); i++ )
         if( m_appointmentPartDay[i]->appointmentId() == appointmentId )
         {
-            EventItem* itm = m_appointmentPartDay.takeAt( i );
-            delete itm;
+            releaseEventItem( m_appointmentPartDay.takeAt( i ) );
         }
     m_tooManyItems->hide();
 }
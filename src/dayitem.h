@@ -24,6 +24,8 @@
 #include <QMenu>
 #include <QAction>
 #include <QDate>
+#include <QPair>
+#include <QVector>
 
 #include "appointmentmanager.h"
 
@@ -50,10 +52,10 @@ private:
  * Normal EventItems show a tool tip, a context menu (delete and reconfigure), a title, and a
  * rectangular colored area, representing the duration.
  * If the size of the EventItem within a DayItem is too small, then nothing is shown.
- * Deleting the Event means deleting this event item too: This item may get
- *   deleted during execution of the signal handler. We use here a call to
- *   QMetaObject::invokeMethod(this, "signalDeleteAppointment", Qt::QueuedConnection, Q_ARG(int, m_appointmentId))
- *   in slotPrepareDeleteAppointment() and a "delayed connect" in MainWindow (Qt::QueuedConnection).
+ * EventItems are recycled by their DayItem, setEvent() and setDummy() rebind an existing item.
+ * User actions are emitted directly by the CalendarScene, there are no per-item connections.
+ * Deleting the Event means deleting this event item too, so MainWindow connects to
+ *   CalendarScene::signalDeleteAppointment() with Qt::QueuedConnection.
  */
 class EventItem : public QGraphicsObject
 {
@@ -61,8 +63,9 @@ class EventItem : public QGraphicsObject
 
 public:
     explicit EventItem(QGraphicsItem* parent = 0);    // dummy Item
-    explicit EventItem(Event event, QGraphicsItem* parent = 0);
-    ~EventItem();
+    explicit EventItem(const Event & event, QGraphicsItem* parent = 0);
+    void setEvent(const Event & event);
+    void setDummy();
     bool dummy() const { return m_dummy; }
     QRectF boundingRect() const { return QRectF({0, 0}, m_size); }
     QDateTime startDt() const { return m_startDt; }
@@ -88,30 +91,45 @@ private:
     QString m_appointmentId;
     QDateTime m_startDt, m_endDt;
     bool m_allDay;
-    // context menu
-    QMenu m_contextMenu;
-    QAction* m_actionReconfigureAppointment;
-    QAction* m_deleteThisAppointment;
+
+    void prepareReconfigureAppointment();
+    void prepareDeleteAppointment();
 
 protected:
     void keyReleaseEvent(QKeyEvent* event);
     void mousePressEvent(QGraphicsSceneMouseEvent* event);
     void contextMenuEvent(QGraphicsSceneContextMenuEvent* event);
+};
+
 
-signals:
-    void signalReconfigureAppointment(QString apointmentId);
-    void signalDeleteAppointment(const QString appointmentId);
 
-private slots:
-    void slotPrepareReconfigureAppointment();
-    void slotPrepareDeleteAppointment();
+/* Events of a single day, bucketed once by CalendarScene for all items of a view.
+ * m_rangeEvents are events longer than a day with their slot number, ascending by slot.
+ * m_dayEvents start and end on this day. */
+struct DayEvents
+{
+    QVector<QPair<int, Event>>  m_rangeEvents;
+    QVector<Event>              m_dayEvents;
+};
+
+
+
+/* Label texts and style of a day. They are computed once per year and
+ * shared by all DayItems, see DayItem::dayLabel(). */
+struct DayLabel
+{
+    QString m_shortText;        // "dd"
+    QString m_yearText;         // "dd ddd" for the year view
+    QString m_weekNumberText;   // on mondays and on the first of a month, else empty
+    QColor  m_color;
+    bool    m_bold;             // today
 };
 
 
 
 /* DayItem is the base class of all items representing days.
- * DayItems emits a signal on double click and forwards appointment
- * signals to the CalendarScene.
+ * DayItems emits a signal on double click and keeps spare EventItems, so
+ * changing the date or the events does not reallocate them.
  * Setting the right font for the given item size and display a day number
  * label is a main part of DayItem. */
 class DayItem : public QGraphicsObject
@@ -128,23 +146,26 @@ public:
     virtual void setDate(const QDate date);
     QDate date() const { return m_displayDate; }
     void setDayText(const QString dayString);
+    void setRasterCache(const bool enable);
+    static const DayLabel & dayLabel(const QDate & date);
+    // the today of the labels handed out so far, they are stale if it is not today anymore
+    static QDate dayLabelsToday();
 
 private:
     QDate m_displayDate;
+    QVector<EventItem*> m_spareEventItems;  // hidden children, ready for reuse
 
 protected:
     QGraphicsSimpleTextItem* m_dayLabel;
     QSizeF m_size;
     void mouseDoubleClickEvent(QGraphicsSceneMouseEvent* event);
+    // child EventItems, taken from and given back to the spare items
+    EventItem* newEventItem(const Event & event);
+    EventItem* newDummyEventItem();
+    void releaseEventItem(EventItem* itm);
 
 signals:
-    void signalReconfigureAppointment(QString apointmentId);
-    void signalDeleteAppointment(QString apointmentId);
     void signalDateClicked(const QDate & date);
-
-public slots:
-    void slotDeleteAppointment( QString appointmentId);
-
 };
 
 
@@ -169,8 +190,7 @@ public:
     void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget);
     virtual void setDate(const QDate date);
 
-    void setAppointmentDaySlots(const QVector<Event> &list);
-    void setAppointmentRangeSlot(const int slot, const QVector<Event> &list);
+    void setDayEvents(const DayEvents & events);
     void removeEvents();
     void removeEvents( const QString appointmentId );
 
@@ -202,8 +222,7 @@ public:
     void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget);
     virtual void setDate(const QDate date);
 
-    void setAppointmentRangeSlot(const int slot, const QVector<Event> &list, int weekStart);
-    void setAppointments(const QVector<Event> &list);
+    void setDayEvents(const DayEvents & events, const int weekStart);
     void removeEvents();
     void removeEvents( const QString appointmentId );
 
@@ -235,8 +254,7 @@ public:
     void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget);
     virtual void setDate(const QDate date);
 
-    void setAppointmentRangeSlot(const int slot, const QVector<Event> &list, int weekStart);
-    void setAppointments(const QVector<Event> &list);
+    void setDayEvents(const DayEvents & events, const int weekStart);
     void removeEvents();
     void removeEvents( const QString appointmentId );
 
@@ -24,6 +24,7 @@ SOURCES += main.cpp\
     appointmentmanager.cpp \
     ../icalreader/icalbody.cpp \
     ../icalreader/icalinterpreter.cpp \
+    ../icalreader/icalwriter.cpp \
     ../icalreader/parameter.cpp \
     ../icalreader/property.cpp \
     ../icalreader/standarddaylightcomponent.cpp \
@@ -35,14 +36,19 @@ SOURCES += main.cpp\
     ../icalreader/vtodocomponent.cpp \
     icalimportdialog.cpp \
     icalimportthread.cpp \
+    importstoragethread.cpp \
+    importscheduler.cpp \
+    appointmentqueue.cpp \
     calendarheader.cpp \
     settingsdialog.cpp \
     eventpool.cpp \
+    eventcache.cpp \
     dayitem.cpp \
     calendarscene.cpp \
     navigationdialog.cpp \
     appointmentdialog.cpp \
-    calendarmanagerdialog.cpp
+    calendarmanagerdialog.cpp \
+    alarmscheduler.cpp
 
 HEADERS  += mainwindow.h \
     storage.h \
@@ -52,6 +58,8 @@ HEADERS  += mainwindow.h \
     appointmentmanager.h \
     ../icalreader/icalbody.h \
     ../icalreader/icalinterpreter.h \
+    ../icalreader/icalnames.h \
+    ../icalreader/icalwriter.h \
     ../icalreader/parameter.h \
     ../icalreader/property.h \
     ../icalreader/standarddaylightcomponent.h \
@@ -63,14 +71,19 @@ HEADERS  += mainwindow.h \
     ../icalreader/vtodocomponent.h \
     icalimportdialog.h \
     icalimportthread.h \
+    importstoragethread.h \
+    importscheduler.h \
+    appointmentqueue.h \
     calendarheader.h \
     settingsdialog.h \
     eventpool.h \
+    eventcache.h \
     dayitem.h \
     calendarscene.h \
     navigationdialog.h \
     appointmentdialog.h \
-    calendarmanagerdialog.h
+    calendarmanagerdialog.h \
+    alarmscheduler.h
 
 FORMS    += ui/mainwindow.ui \
     ui/appointmentdialog.ui \
@@ -0,0 +1,241 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "eventcache.h"
+
+#include <cstring>
+
+#include <QDebug>
+#include <QHash>
+
+
+EventCache::EventCache( const QString & inFilename )
+    :
+      m_filename( inFilename ),
+      m_map( nullptr ),
+      m_havePendingSnapshot( false )
+{
+    // the layout is the file format. If this fails, increase EVENT_CACHE_VERSION
+    static_assert( sizeof(EventCacheHeader) == 48, "EventCacheHeader must be 48 bytes" );
+    static_assert( sizeof(EventCacheRecord) == 72, "EventCacheRecord must be 72 bytes" );
+}
+
+
+EventCache::~EventCache()
+{
+    if( m_map )
+    {
+        m_file.unmap( m_map );
+        m_map = nullptr;
+    }
+    m_file.close();
+    if( m_havePendingSnapshot )
+    {
+        QFile::remove( m_filename );
+        if( not QFile::rename( m_filename + ".tmp", m_filename ) )
+            qDebug() << "ERR: EventCache::~EventCache(), cannot rename snapshot";
+    }
+}
+
+
+bool EventCache::load( const qint64 inChangeCounter, QMap<int, QVector<Event>> &outEventsByYear )
+{
+    outEventsByYear.clear();
+    if( m_map )
+        return false;   // we read only one snapshot per program run
+
+    m_file.setFileName( m_filename );
+    if( not m_file.open( QIODevice::ReadOnly ) )
+        return false;
+    const qint64 fileSize = m_file.size();
+    if( fileSize < static_cast<qint64>(sizeof(EventCacheHeader)) )
+    {
+        m_file.close();
+        return false;
+    }
+    m_map = m_file.map( 0, fileSize );
+    if( not m_map )
+    {
+        m_file.close();
+        return false;
+    }
+
+    const EventCacheHeader* header = reinterpret_cast<const EventCacheHeader*>( m_map );
+    const quint64 size = static_cast<quint64>( fileSize );
+    bool valid = std::memcmp( header->m_magic, "DLEC", 4 ) == 0 and
+            header->m_version == EVENT_CACHE_VERSION and
+            header->m_byteOrderMark == 0x01020304 and
+            header->m_recordSize == sizeof(EventCacheRecord) and
+            header->m_changeCounter == inChangeCounter and
+            header->m_recordsOffset % alignof(EventCacheRecord) == 0 and
+            header->m_stringsOffset % alignof(QChar) == 0 and
+            header->m_recordsOffset + header->m_numRecords * sizeof(EventCacheRecord) <= size and
+            header->m_stringsOffset + header->m_numChars * sizeof(QChar) <= size;
+    if( not valid )
+    {
+        m_file.unmap( m_map );
+        m_map = nullptr;
+        m_file.close();
+        return false;
+    }
+
+    const EventCacheRecord* records = reinterpret_cast<const EventCacheRecord*>( m_map + header->m_recordsOffset );
+    const QChar* strings = reinterpret_cast<const QChar*>( m_map + header->m_stringsOffset );
+    const quint64 numChars = header->m_numChars;
+    auto inStringTable = [numChars]( const quint32 inOffset, const quint32 inLength )
+    {
+        return static_cast<quint64>( inOffset ) + inLength <= numChars;
+    };
+
+    // QTimeZone is expensive to construct, most events share some few zones
+    QHash<quint64, QTimeZone> timeZones;
+    auto timeZone = [&timeZones, strings]( const quint32 inOffset, const quint32 inLength ) -> QTimeZone
+    {
+        quint64 tzKey = ( static_cast<quint64>( inOffset ) << 32 ) | inLength;
+        QHash<quint64, QTimeZone>::const_iterator tzIt = timeZones.constFind( tzKey );
+        if( tzIt == timeZones.constEnd() )
+        {
+            QTimeZone tz( QString( strings + inOffset, inLength ).toUtf8() );
+            if( not tz.isValid() )
+                tz = QTimeZone::systemTimeZone();
+            tzIt = timeZones.insert( tzKey, tz );
+        }
+        return tzIt.value();
+    };
+
+    for( quint32 i = 0; i < header->m_numRecords; i++ )
+    {
+        const EventCacheRecord &r = records[i];
+        if( not inStringTable( r.m_uidOffset, r.m_uidLength ) or
+            not inStringTable( r.m_textOffset, r.m_textLength ) or
+            not inStringTable( r.m_startTzOffset, r.m_startTzLength ) or
+            not inStringTable( r.m_endTzOffset, r.m_endTzLength ) )
+            continue;
+
+        Event e;
+        // zero copy, strings point into the mapped file
+        e.m_uid = QString::fromRawData( strings + r.m_uidOffset, r.m_uidLength );
+        e.m_displayText = QString::fromRawData( strings + r.m_textOffset, r.m_textLength );
+        e.m_startDt = makeDateTime( r.m_startJulianDay, r.m_startMSecs,
+                                    r.m_flags & RF_START_IS_DATE, r.m_flags & RF_START_IS_UTC,
+                                    timeZone( r.m_startTzOffset, r.m_startTzLength ) );
+        e.m_endDt = makeDateTime( r.m_endJulianDay, r.m_endMSecs,
+                                  r.m_flags & RF_END_IS_DATE, r.m_flags & RF_END_IS_UTC,
+                                  timeZone( r.m_endTzOffset, r.m_endTzLength ) );
+        e.m_isAlarmEvent = r.m_flags & RF_IS_ALARM;
+        e.m_userCalendarId = r.m_userCalendarId;
+        outEventsByYear[r.m_year].append( e );
+    }
+    return true;
+}
+
+
+bool EventCache::save( const qint64 inChangeCounter, const QMap<int, QVector<Event>> &inEventsByYear )
+{
+    QVector<EventCacheRecord> records;
+    QString stringTable;
+    QHash<QString, quint32> stringOffsets;
+    auto addString = [&stringTable, &stringOffsets]( const QString &inString, quint32 &outOffset, quint32 &outLength )
+    {
+        outLength = static_cast<quint32>( inString.size() );
+        QHash<QString, quint32>::const_iterator it = stringOffsets.constFind( inString );
+        if( it != stringOffsets.constEnd() )
+        {
+            outOffset = it.value();
+            return;
+        }
+        outOffset = static_cast<quint32>( stringTable.size() );
+        stringOffsets.insert( inString, outOffset );
+        stringTable.append( inString );
+    };
+
+    for( QMap<int, QVector<Event>>::const_iterator it = inEventsByYear.constBegin(); it != inEventsByYear.constEnd(); ++it )
+    {
+        for( const Event &e : it.value() )
+        {
+            EventCacheRecord r;
+            std::memset( &r, 0, sizeof(r) );
+            r.m_startJulianDay = e.m_startDt.date().toJulianDay();
+            r.m_endJulianDay = e.m_endDt.date().toJulianDay();
+            r.m_startMSecs = e.m_startDt.isDate() ? 0 : e.m_startDt.time().msecsSinceStartOfDay();
+            r.m_endMSecs = e.m_endDt.isDate() ? 0 : e.m_endDt.time().msecsSinceStartOfDay();
+            addString( e.m_uid, r.m_uidOffset, r.m_uidLength );
+            addString( e.m_displayText, r.m_textOffset, r.m_textLength );
+            QString tzId;
+            if( not e.m_startDt.isDate() and not e.m_startDt.isUtc() )
+                tzId = QString::fromUtf8( e.m_startDt.timeZone().id() );
+            addString( tzId, r.m_startTzOffset, r.m_startTzLength );
+            tzId.clear();
+            if( not e.m_endDt.isDate() and not e.m_endDt.isUtc() )
+                tzId = QString::fromUtf8( e.m_endDt.timeZone().id() );
+            addString( tzId, r.m_endTzOffset, r.m_endTzLength );
+            r.m_userCalendarId = e.m_userCalendarId;
+            r.m_year = it.key();
+            r.m_flags = ( e.m_startDt.isDate() ? RF_START_IS_DATE : 0 ) |
+                        ( e.m_startDt.isUtc() ? RF_START_IS_UTC : 0 ) |
+                        ( e.m_endDt.isDate() ? RF_END_IS_DATE : 0 ) |
+                        ( e.m_endDt.isUtc() ? RF_END_IS_UTC : 0 ) |
+                        ( e.m_isAlarmEvent ? RF_IS_ALARM : 0 );
+            records.append( r );
+        }
+    }
+
+    EventCacheHeader header;
+    std::memset( &header, 0, sizeof(header) );
+    std::memcpy( header.m_magic, "DLEC", 4 );
+    header.m_version = EVENT_CACHE_VERSION;
+    header.m_byteOrderMark = 0x01020304;
+    header.m_recordSize = sizeof(EventCacheRecord);
+    header.m_changeCounter = inChangeCounter;
+    header.m_numRecords = static_cast<quint32>( records.size() );
+    header.m_numChars = static_cast<quint32>( stringTable.size() );
+    header.m_recordsOffset = sizeof(EventCacheHeader);
+    header.m_stringsOffset = header.m_recordsOffset + records.size() * sizeof(EventCacheRecord);
+
+    QFile out( m_filename + ".tmp" );
+    if( not out.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        qDebug() << "ERR: EventCache::save(), cannot open " << out.fileName();
+        return false;
+    }
+    const qint64 recordBytes = records.size() * static_cast<qint64>( sizeof(EventCacheRecord) );
+    const qint64 stringBytes = stringTable.size() * static_cast<qint64>( sizeof(QChar) );
+    bool ok = out.write( reinterpret_cast<const char*>( &header ), sizeof(header) ) == sizeof(header) and
+            out.write( reinterpret_cast<const char*>( records.constData() ), recordBytes ) == recordBytes and
+            out.write( reinterpret_cast<const char*>( stringTable.constData() ), stringBytes ) == stringBytes;
+    out.close();
+    if( not ok )
+    {
+        qDebug() << "ERR: EventCache::save(), cannot write " << out.fileName();
+        out.remove();
+        return false;
+    }
+    m_havePendingSnapshot = true;
+    return true;
+}
+
+
+DateTime EventCache::makeDateTime( const qint64 inJulianDay, const qint32 inMSecs,
+                                   const bool inIsDate, const bool inIsUtc, const QTimeZone &inTimeZone )
+{
+    QDate date = QDate::fromJulianDay( inJulianDay );
+    if( inIsDate )
+        return DateTime( date );
+    QTime time = QTime::fromMSecsSinceStartOfDay( inMSecs );
+    if( inIsUtc )
+        return DateTime( date, time, QTimeZone::utc() );
+    return DateTime( date, time, inTimeZone );
+}
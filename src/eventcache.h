@@ -0,0 +1,104 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef EVENTCACHE_H
+#define EVENTCACHE_H
+
+#include <QFile>
+#include <QMap>
+#include <QVector>
+
+#include "appointmentmanager.h"
+
+
+/* On-disk snapshot of the events of some years from EventPool, so the first paint after
+ *  program start does not need to wait for the database.
+ * The file is a flat, versioned format, which is memory mapped on load:
+ *  - EventCacheHeader
+ *  - fixed size EventCacheRecord for each event
+ *  - a string table with UTF-16 data, referenced by the records
+ * Strings are not copied on load, they point into the mapped file. So the cache must live
+ *  longer than every Event it has delivered.
+ * The snapshot carries the change counter of Storage. If the database has changed
+ *  since the snapshot was written, load() refuses it.
+ */
+class EventCache
+{
+public:
+    static const quint32 EVENT_CACHE_VERSION = 2;
+
+    explicit EventCache( const QString & inFilename = QString( "daylightcache.bin" ) );
+    ~EventCache();
+
+    // true, if the snapshot exists and was written with inChangeCounter
+    bool load( const qint64 inChangeCounter, QMap<int, QVector<Event>> &outEventsByYear );
+
+    /* write a new snapshot. As the current file may still be mapped, this goes to a
+     *  temporary file, which replaces the snapshot in the destructor. */
+    bool save( const qint64 inChangeCounter, const QMap<int, QVector<Event>> &inEventsByYear );
+
+private:
+    struct EventCacheHeader
+    {
+        char    m_magic[4];         // "DLEC"
+        quint32 m_version;          // EVENT_CACHE_VERSION
+        quint32 m_byteOrderMark;    // 0x01020304, written in native byte order
+        quint32 m_recordSize;       // sizeof(EventCacheRecord)
+        qint64  m_changeCounter;    // Storage::changeCounter() at time of writing
+        quint32 m_numRecords;
+        quint32 m_numChars;         // size of string table in QChar
+        quint64 m_recordsOffset;    // from start of file
+        quint64 m_stringsOffset;    // from start of file
+    };
+
+    struct EventCacheRecord
+    {
+        qint64  m_startJulianDay;
+        qint64  m_endJulianDay;
+        qint32  m_startMSecs;       // msecs since start of day
+        qint32  m_endMSecs;
+        quint32 m_uidOffset;        // offsets and lengths in QChar
+        quint32 m_uidLength;
+        quint32 m_textOffset;
+        quint32 m_textLength;
+        quint32 m_startTzOffset;    // time zone id of m_startDt
+        quint32 m_startTzLength;
+        quint32 m_endTzOffset;      // time zone id of m_endDt
+        quint32 m_endTzLength;
+        qint32  m_userCalendarId;
+        qint32  m_year;             // year list this event belongs to
+        quint8  m_flags;            // see RecordFlags
+        quint8  m_reserved[7];
+    };
+
+    enum RecordFlags : quint8 {
+        RF_START_IS_DATE = 1,
+        RF_START_IS_UTC = 2,
+        RF_END_IS_DATE = 4,
+        RF_END_IS_UTC = 8,
+        RF_IS_ALARM = 16
+    };
+
+    static DateTime makeDateTime( const qint64 inJulianDay, const qint32 inMSecs,
+                                  const bool inIsDate, const bool inIsUtc, const QTimeZone &inTimeZone );
+
+    QString         m_filename;
+    QFile           m_file;
+    uchar*          m_map;          // mapped snapshot or nullptr
+    bool            m_havePendingSnapshot;
+};
+
+#endif // EVENTCACHE_H
@@ -18,6 +18,8 @@
 
 #include <QDebug>
 
+#include <algorithm>
+
 EventPool::EventPool()
 {
 }
@@ -26,32 +28,81 @@ EventPool::EventPool()
 void EventPool::addAppointment( Appointment* inApp )
 {
     // empty Appointments should not exist
-    if( inApp->m_eventVector.isEmpty() )
+    if( inApp->m_eventVector.isEmpty() and not inApp->isStreamed() )
         return;
 
     // check, we don't read duplicates
-    if( m_appointmentsRead.contains( inApp->m_uid ) )
+    if( m_appointmentsByUid.contains( inApp->m_uid ) )
         return;
 
-    m_appointments.append( inApp );
-    m_appointmentsRead.insert( inApp->m_uid  );
+    m_appointments[inApp->m_userCalendarId].append( inApp );
+    m_appointmentsByUid.insert( inApp->m_uid, inApp );
+    if( inApp->m_appBasics->m_busyFree == AppointmentBasics::FREE )
+        m_freeAppointments.insert( inApp->m_uid );
+    if( inApp->isStreamed() )
+        m_streamedAppointments.append( inApp );
+
+    for( const Event &e : inApp->m_eventVector )
+        addEvent( e );
+}
 
-    for( const Event e : inApp->m_eventVector )
+
+/* an event goes to its calendar partition, into every year it touches.
+ * Cached years already have a copy of it, dropCachedEvents() adds it there. */
+void EventPool::addEvent( const Event &inEvent )
+{
+    QMap<int, YearEvents> &partition = m_partitions[inEvent.m_userCalendarId];
+    for( int year = inEvent.m_startDt.date().year() ; year <= inEvent.m_endDt.date().year(); year++)
     {
-        for( int year = e.m_startDt.date().year() ; year <= e.m_endDt.date().year(); year++)
-        {
-            if( m_eventMap.contains( year ) )
-            {
-                QVector<Event> &events = m_eventMap[year];
-                events.append( e );
-            }
-            else
-            {
-                QVector<Event> events;
-                events.append( e );
-                m_eventMap.insert( year, events );
-            }
-        }
+        if( not m_cachedYears.contains( year ) )
+            addToYear( partition[year], inEvent );
+    }
+}
+
+
+void EventPool::addToYear( YearEvents &inoutYear, const Event &inEvent )
+{
+    const QDate startDate = inEvent.m_startDt.date();
+    if( inoutYear.m_sorted and not inoutYear.m_events.isEmpty() and
+        inoutYear.m_events.last().m_startDt.date() > startDate )
+        inoutYear.m_sorted = false;
+    inoutYear.m_events.append( inEvent );
+    inoutYear.m_maxSpanDays = qMax( inoutYear.m_maxSpanDays,
+                                    static_cast<int>( startDate.daysTo( inEvent.m_endDt.date() ) ) );
+}
+
+
+void EventPool::removeFromYear( YearEvents &inoutYear, const QString &inUid )
+{
+    // keeps the order, so a sorted year stays sorted
+    auto it = std::remove_if( inoutYear.m_events.begin(), inoutYear.m_events.end(),
+                              [&inUid]( const Event & ev ) { return ev.m_uid == inUid; } );
+    inoutYear.m_events.erase( it, inoutYear.m_events.end() );
+}
+
+
+/* Events of inoutYear touching inFirst ... inLast. With inSkipEarlierYears, events starting
+ *  before inFirst are left out, they were taken from an earlier year already.
+ * The year is sorted first, if needed, then only events starting between
+ *  inFirst - m_maxSpanDays and inLast are looked at. */
+void EventPool::appendEventsInRange( YearEvents &inoutYear, const QDate &inFirst, const QDate &inLast,
+                                     const bool inSkipEarlierYears, QVector<Event> &outEvents )
+{
+    QVector<Event> &events = inoutYear.m_events;
+    if( not inoutYear.m_sorted )
+    {
+        std::stable_sort( events.begin(), events.end(), []( const Event &a, const Event &b )
+                          { return a.m_startDt.date() < b.m_startDt.date(); } );
+        inoutYear.m_sorted = true;
+    }
+    const QDate earliestStart = inSkipEarlierYears ? inFirst : inFirst.addDays( -inoutYear.m_maxSpanDays );
+    auto it = std::lower_bound( events.cbegin(), events.cend(), earliestStart,
+                                []( const Event &e, const QDate &d ) { return e.m_startDt.date() < d; } );
+    for( ; it != events.cend() and it->m_startDt.date() <= inLast; ++it )
+    {
+        if( it->m_endDt.date() < inFirst )
+            continue;
+        outEvents.append( *it );
     }
 }
 
@@ -65,55 +116,71 @@ void EventPool::updateAppointment( Appointment* inApp )
 
 void EventPool::removeAppointmentWithEventsById( const QString inUid )
 {
-    m_appointmentsRead.remove( inUid );
+    m_freeAppointments.remove( inUid );
 
-    for( int year : m_eventMap.keys() )
+    // only the years of the appointment in its partition need a walk, cached events may be anywhere
+    Appointment* app = m_appointmentsByUid.take( inUid );
+    if( app == nullptr )
     {
-        QVector<Event> events = m_eventMap.take( year );
-        QVector<Event> newEvents;
-        for( Event ev : events )
+        for( QMap<int, YearEvents> &partition : m_partitions )
         {
-            if( ev.m_uid != inUid )
-                newEvents.append( ev );
+            for( const int year : m_cachedYears )
+            {
+                auto yearIt = partition.find( year );
+                if( yearIt != partition.end() )
+                    removeFromYear( yearIt.value(), inUid );
+            }
         }
-        m_eventMap.insert( year, newEvents );
-        events.clear();
+        return;
     }
 
-    for( Appointment* app : m_appointments )
+    QSet<int> years = m_cachedYears;
+    for( const Event &e : app->m_eventVector )
     {
-        if( app->m_uid == inUid )
+        for( int year = e.m_startDt.date().year() ; year <= e.m_endDt.date().year(); year++)
+            years.insert( year );
+    }
+    auto partIt = m_partitions.find( app->m_userCalendarId );
+    if( partIt != m_partitions.end() )
+    {
+        for( const int year : years )
         {
-            m_appointments.removeOne( app );
-            delete app;
-            break;
+            auto yearIt = partIt.value().find( year );
+            if( yearIt != partIt.value().end() )
+                removeFromYear( yearIt.value(), inUid );
         }
     }
+
+    m_appointments[app->m_userCalendarId].removeOne( app );
+    m_streamedAppointments.removeOne( app );
+    delete app;
+}
+
+
+void EventPool::removeAppointmentsByCalendarId( const int inUserCalendarId )
+{
+    for( Appointment* app : m_appointments.take( inUserCalendarId ) )
+    {
+        m_appointmentsByUid.remove( app->m_uid );
+        m_freeAppointments.remove( app->m_uid );
+        if( app->isStreamed() )
+            m_streamedAppointments.removeOne( app );
+        delete app;
+    }
+
+    m_partitions.remove( inUserCalendarId );
 }
 
 
 bool EventPool::haveAppointment( const QString inUid ) const
 {
-    return m_appointmentsRead.contains( inUid );
+    return m_appointmentsByUid.contains( inUid );
 }
 
 
 const Appointment* EventPool::appointment( const QString inUid ) const
 {
-    const Appointment* tmp;
-    bool found = false;
-    for( const Appointment* app : m_appointments )
-    {
-        if( app->m_uid == inUid )
-        {
-            found = true;
-            tmp = app;
-            break;
-        }
-    }
-    if( found )
-        return tmp;
-    return nullptr;
+    return m_appointmentsByUid.value( inUid, nullptr );
 }
 
 
@@ -129,105 +196,298 @@ bool EventPool::queryMarker( const int inMarkerYear ) const
 }
 
 
-void EventPool::changeColor(const int inUserCalendarId, const QColor inNewColor)
+void EventPool::addCachedEvents( const int inYear, const QVector<Event> &inEvents )
+{
+    if( m_yearMarkers.contains( inYear ) )
+        return;
+    for( const Event &e : inEvents )
+        addToYear( m_partitions[e.m_userCalendarId][inYear], e );
+    m_cachedYears.insert( inYear );
+}
+
+
+bool EventPool::haveCachedYear( const int inYear ) const
+{
+    return m_cachedYears.contains( inYear );
+}
+
+
+bool EventPool::haveCachedEvents() const
 {
-    for( Appointment* app : m_appointments )
+    return not m_cachedYears.isEmpty();
+}
+
+
+void EventPool::dropCachedEvents()
+{
+    for( QMap<int, YearEvents> &partition : m_partitions )
+    {
+        for( const int year : m_cachedYears )
+            partition.remove( year );
+    }
+    // appointments read meanwhile for other years may have events in the cached years, too
+    for( const Appointment* app : m_appointmentsByUid )
     {
-        if( app->m_userCalendarId == inUserCalendarId )
+        for( const Event &e : app->m_eventVector )
         {
-            for( Event &e : app->m_eventVector )
+            for( int year = e.m_startDt.date().year() ; year <= e.m_endDt.date().year(); year++)
             {
-                qDebug() << " somone got a new color";
-                e.m_eventColor = inNewColor;
+                if( m_cachedYears.contains( year ) )
+                    addToYear( m_partitions[e.m_userCalendarId][year], e );
             }
         }
     }
+    m_cachedYears.clear();
 }
 
 
-QVector<Event> EventPool::eventsByYear( const int inYear ) const
+QList<int> EventPool::markedYears() const
 {
-    QVector<Event> events = m_eventMap.value( inYear );
-    return events;
+    return m_yearMarkers.values();
 }
 
 
-QVector<Event> EventPool::eventsByYearMonth( const int inYear, const int inMonth ) const
+void EventPool::changeColor(const int inUserCalendarId, const QColor inNewColor)
 {
-    QVector<Event> events = m_eventMap.value( inYear );
-    if( events.isEmpty() )
-        return events;
-    QVector<Event> events_month;
+    auto appIt = m_appointments.find( inUserCalendarId );
+    if( appIt != m_appointments.end() )
+    {
+        for( Appointment* app : appIt.value() )
+            app->setEventColor( inNewColor );
+    }
+    // events shown are copies within the partition of this calendar
+    auto it = m_partitions.find( inUserCalendarId );
+    if( it == m_partitions.end() )
+        return;
+    for( YearEvents &year : it.value() )
+    {
+        for( Event &e : year.m_events )
+            e.m_eventColor = inNewColor;
+    }
+}
 
-    QDate firstOfMonth = QDate( inYear, inMonth, 1 );
-    QDate lastOfMonth = QDate( inYear, inMonth, firstOfMonth.daysInMonth() );
 
-    for( const Event e : events )
+/* true, if the user calendar is switched off */
+static inline bool isHidden( const int inUserCalendarId, const QBitArray &inHiddenCalendars )
+{
+    return inUserCalendarId >= 0 and inUserCalendarId < inHiddenCalendars.size() and
+            inHiddenCalendars.testBit( inUserCalendarId );
+}
+
+
+/* Merge the visible partitions: all events touching inFirst ... inLast.
+ * Events longer than a year are stored in every year, they are taken from the
+ * first year of the range they are stored in. */
+QVector<Event> EventPool::eventsInRange( const QDate &inFirst, const QDate &inLast, const QBitArray &inHiddenCalendars ) const
+{
+    QVector<Event> result;
+    for( auto partIt = m_partitions.begin(); partIt != m_partitions.end(); ++partIt )
     {
-        if( e.m_endDt.date() >= firstOfMonth and e.m_startDt.date() <= lastOfMonth )
-            events_month.append( e );
+        if( isHidden( partIt.key(), inHiddenCalendars ) )
+            continue;
+        QMap<int, YearEvents> &partition = partIt.value();
+        for( int year = inFirst.year(); year <= inLast.year(); year++ )
+        {
+            auto yearIt = partition.find( year );
+            if( yearIt == partition.end() )
+                continue;
+            // from the second year on, events of earlier years are taken already
+            const QDate first = year > inFirst.year() ? QDate( year, 1, 1 ) : inFirst;
+            appendEventsInRange( yearIt.value(), first, inLast, year > inFirst.year(), result );
+        }
     }
-    return events_month;
+    appendStreamedEvents( inFirst, inLast, inHiddenCalendars, result );
+    return result;
 }
 
 
-QVector<Event> EventPool::eventsBy3Weeks( const QDate date )
+void EventPool::appendStreamedEvents( const QDate &inFirst, const QDate &inLast, const QBitArray &inHiddenCalendars,
+                                      QVector<Event> &outEvents ) const
 {
-    QDate firstOfRange = date;
-    // @fixme: explicit week start
-    firstOfRange = firstOfRange.addDays( 1 - firstOfRange.dayOfWeek() - 7 );
-    QDate lastOfRange = firstOfRange.addDays( 20 );
-    QVector<Event> events = m_eventMap.value( date.year() );
+    for( const Appointment* app : m_streamedAppointments )
+    {
+        if( not isHidden( app->m_userCalendarId, inHiddenCalendars ) )
+            app->appendStreamedEvents( inFirst, inLast, MAX_STREAMED_EVENTS_PER_DAY, outEvents );
+    }
+}
 
-    // load other years, if we overlap a year-boundary
-    if( firstOfRange.year() < date.year() )
-        events.append( m_eventMap.value( firstOfRange.year() ) );
-    if( lastOfRange.year() > date.year() )
-        events.append( m_eventMap.value( lastOfRange.year() ) );
 
-    QVector<Event> events3Weeks;
-    for( const Event e : events )
+QVector<Event> EventPool::eventsByYear( const int inYear, const QBitArray &inHiddenCalendars ) const
+{
+    QVector<Event> events;
+    for( auto partIt = m_partitions.constBegin(); partIt != m_partitions.constEnd(); ++partIt )
     {
-        if( e.m_endDt.date() >= firstOfRange and e.m_startDt.date() <= lastOfRange )
-            events3Weeks.append( e );
+        if( isHidden( partIt.key(), inHiddenCalendars ) )
+            continue;
+        events.append( partIt.value().value( inYear ).m_events );
     }
-    return events3Weeks;
+    appendStreamedEvents( QDate( inYear, 1, 1 ), QDate( inYear, 12, 31 ), inHiddenCalendars, events );
+    return events;
+}
+
+
+QVector<Event> EventPool::storedEventsByYear( const int inYear ) const
+{
+    QVector<Event> events;
+    for( const QMap<int, YearEvents> &partition : m_partitions )
+        events.append( partition.value( inYear ).m_events );
+    return events;
+}
+
+
+QVector<Event> EventPool::eventsByYearMonth( const int inYear, const int inMonth, const QBitArray &inHiddenCalendars ) const
+{
+    QDate firstOfMonth = QDate( inYear, inMonth, 1 );
+    QDate lastOfMonth = QDate( inYear, inMonth, firstOfMonth.daysInMonth() );
+    return eventsInRange( firstOfMonth, lastOfMonth, inHiddenCalendars );
 }
 
 
-QVector<Event> EventPool::eventsByWeek( const QDate date )
+QVector<Event> EventPool::eventsBy3Weeks( const QDate date, const QBitArray &inHiddenCalendars )
+{
+    QDate firstOfRange = date;
+    // @fixme: explicit week start
+    firstOfRange = firstOfRange.addDays( 1 - firstOfRange.dayOfWeek() - 7 );
+    QDate lastOfRange = firstOfRange.addDays( 20 );
+    return eventsInRange( firstOfRange, lastOfRange, inHiddenCalendars );
+}
+
+
+QVector<Event> EventPool::eventsByWeek( const QDate date, const QBitArray &inHiddenCalendars )
 {
     QDate firstOfRange = date;
     // @fixme: explicit week start
     firstOfRange = firstOfRange.addDays( 1 - firstOfRange.dayOfWeek() );
     QDate lastOfRange = firstOfRange.addDays( 6 );
+    return eventsInRange( firstOfRange, lastOfRange, inHiddenCalendars );
+}
+
+
+QVector<Event> EventPool::eventsByDay( const QDate date, const QBitArray &inHiddenCalendars )
+{
+    return eventsInRange( date, date, inHiddenCalendars );
+}
+
+
+/* local midnight for all-day events, an all-day event lasts at least its day */
+static void eventSecs( const DateTime &inStart, const DateTime &inEnd, qint64 &outStartSecs, qint64 &outEndSecs )
+{
+    if( inStart.isDate() )
+    {
+        QDate endDate = inEnd.date() > inStart.date() ? inEnd.date() : inStart.date().addDays( 1 );
+        outStartSecs = QDateTime( inStart.date(), QTime( 0, 0 ) ).toSecsSinceEpoch();
+        outEndSecs = QDateTime( endDate, QTime( 0, 0 ) ).toSecsSinceEpoch();
+        return;
+    }
+    outStartSecs = inStart.toSecsSinceEpoch();
+    outEndSecs = inEnd.toSecsSinceEpoch();
+}
+
+
+static inline bool isSelected( const int inUserCalendarId, const QBitArray &inUserCalendars )
+{
+    return inUserCalendarId >= 0 and inUserCalendarId < inUserCalendars.size() and
+            inUserCalendars.testBit( inUserCalendarId );
+}
+
+
+/* Collect the busy intervals from the partitions, the streamed appointments and the
+ *  published periods, sort them by start and merge them in one sweep. */
+QVector<FreeBusyInterval> EventPool::busyIntervals( const QDate &inFirst, const QDate &inLast,
+                                                    const QBitArray &inUserCalendars,
+                                                    const QVector<FreeBusyPeriod> &inPublishedBusy ) const
+{
+    const qint64 rangeStart = QDateTime( inFirst, QTime( 0, 0 ) ).toSecsSinceEpoch();
+    const qint64 rangeEnd = QDateTime( inLast.addDays( 1 ), QTime( 0, 0 ) ).toSecsSinceEpoch();
+
+    QVector<FreeBusyInterval> intervals;
+    auto addInterval = [&intervals, rangeStart, rangeEnd]( const qint64 inStartSecs, const qint64 inEndSecs )
+    {
+        const qint64 start = qMax( inStartSecs, rangeStart );
+        const qint64 end = qMin( inEndSecs, rangeEnd );
+        if( start < end )
+            intervals.append( FreeBusyInterval{ start, end } );
+    };
+
+    for( auto partIt = m_partitions.begin(); partIt != m_partitions.end(); ++partIt )
+    {
+        if( not isSelected( partIt.key(), inUserCalendars ) )
+            continue;
+        QMap<int, YearEvents> &partition = partIt.value();
+        QVector<Event> events;
+        for( int year = inFirst.year(); year <= inLast.year(); year++ )
+        {
+            auto yearIt = partition.find( year );
+            if( yearIt == partition.end() )
+                continue;
+            const QDate first = year > inFirst.year() ? QDate( year, 1, 1 ) : inFirst;
+            appendEventsInRange( yearIt.value(), first, inLast, year > inFirst.year(), events );
+        }
+        for( const Event &e : events )
+        {
+            if( m_freeAppointments.contains( e.m_uid ) )
+                continue;
+            qint64 startSecs, endSecs;
+            eventSecs( e.m_startDt, e.m_endDt, startSecs, endSecs );
+            addInterval( startSecs, endSecs );
+        }
+    }
+
+    for( const Appointment* app : m_streamedAppointments )
+    {
+        if( not isSelected( app->m_userCalendarId, inUserCalendars ) or
+            app->m_appBasics->m_busyFree == AppointmentBasics::FREE )
+            continue;
+        const qint64 seconds = app->m_appBasics->m_dtStart.secsTo( app->m_appBasics->m_dtEnd );
+        const QDateTime first = QDateTime::fromSecsSinceEpoch( rangeStart - seconds, QTimeZone::utc() );
+        const QDateTime last = QDateTime::fromSecsSinceEpoch( rangeEnd, QTimeZone::utc() );
+        QVector<DateTime> starts;
+        app->occurrenceStarts( DateTime( first.date(), first.time(), QTimeZone::utc() ),
+                               DateTime( last.date(), last.time(), QTimeZone::utc() ), starts );
+        for( const DateTime &start : starts )
+        {
+            const qint64 startSecs = start.toSecsSinceEpoch();
+            addInterval( startSecs, startSecs + seconds );
+        }
+    }
+
+    for( const FreeBusyPeriod &period : inPublishedBusy )
+    {
+        if( isSelected( period.m_userCalendarId, inUserCalendars ) )
+            addInterval( period.m_startSecs, period.m_endSecs );
+    }
 
-    QVector<Event> events = m_eventMap.value( date.year() );
-    // load other years, if we overlap a year-boundary
-    if( firstOfRange.year() < date.year() )
-        events.append( m_eventMap.value( firstOfRange.year() ) );
-    if( lastOfRange.year() > date.year() )
-        events.append( m_eventMap.value( lastOfRange.year() ) );
+    std::sort( intervals.begin(), intervals.end(),
+               []( const FreeBusyInterval &a, const FreeBusyInterval &b ) { return a.m_startSecs < b.m_startSecs; } );
 
-    QVector<Event> eventsWeeks;
-    for( const Event e : events )
+    QVector<FreeBusyInterval> merged;
+    for( const FreeBusyInterval &interval : intervals )
     {
-        if( e.m_endDt.date() >= firstOfRange and e.m_startDt.date() <= lastOfRange )
-            eventsWeeks.append( e );
+        if( not merged.isEmpty() and interval.m_startSecs <= merged.last().m_endSecs )
+            merged.last().m_endSecs = qMax( merged.last().m_endSecs, interval.m_endSecs );
+        else
+            merged.append( interval );
     }
-    return eventsWeeks;
+    return merged;
 }
 
 
-QVector<Event> EventPool::eventsByDay( const QDate date )
+QVector<FreeBusyInterval> EventPool::freeSlots( const QDate &inFirst, const QDate &inLast,
+                                                const QBitArray &inUserCalendars,
+                                                const QVector<FreeBusyPeriod> &inPublishedBusy, const qint64 inMinSecs ) const
 {
-    QVector<Event> events = m_eventMap.value( date.year() );
-    QVector<Event> eventsDay;
+    const qint64 rangeStart = QDateTime( inFirst, QTime( 0, 0 ) ).toSecsSinceEpoch();
+    const qint64 rangeEnd = QDateTime( inLast.addDays( 1 ), QTime( 0, 0 ) ).toSecsSinceEpoch();
 
-    for( const Event e : events )
+    QVector<FreeBusyInterval> freeIntervals;
+    qint64 freeStart = rangeStart;
+    for( const FreeBusyInterval &busy : busyIntervals( inFirst, inLast, inUserCalendars, inPublishedBusy ) )
     {
-        if( e.m_endDt.date() >= date and e.m_startDt.date() <= date )
-            eventsDay.append( e );
+        if( busy.m_startSecs - freeStart >= inMinSecs )
+            freeIntervals.append( FreeBusyInterval{ freeStart, busy.m_startSecs } );
+        freeStart = busy.m_endSecs;
     }
-    return eventsDay;
+    if( rangeEnd - freeStart >= inMinSecs )
+        freeIntervals.append( FreeBusyInterval{ freeStart, rangeEnd } );
+    return freeIntervals;
 }
@@ -19,12 +19,22 @@
 
 #include "appointmentmanager.h"
 
+#include <QBitArray>
 #include <QColor>
+#include <QHash>
 #include <QMap>
 #include <QSet>
 #include <QVector>
 
 
+/* half-open interval [m_startSecs, m_endSecs) in seconds since epoch, see EventPool::busyIntervals() */
+struct FreeBusyInterval
+{
+    qint64  m_startSecs;
+    qint64  m_endSecs;
+};
+
+
 class EventPool
 {
 public:
@@ -34,6 +44,8 @@ public:
     void addAppointment( Appointment* inApp );
     void updateAppointment( Appointment* inApp );
     void removeAppointmentWithEventsById( const QString inUid );
+    // bulk removal of all appointments and events of a user calendar, single pass
+    void removeAppointmentsByCalendarId( const int inUserCalendarId );
 
     bool haveAppointment( const QString inUid ) const;
     const Appointment* appointment( const QString inUid ) const;
@@ -52,24 +64,86 @@ public:
      * dialogues and such. */
     void changeColor( const int inUserCalendarId, const QColor inNewColor );
 
-    // Events
-    QVector<Event> eventsByYear( const int inYear ) const;
-    QVector<Event> eventsByYearMonth( const int inYear, const int inMonth ) const;
-    QVector<Event> eventsBy3Weeks( const QDate date );
-    QVector<Event> eventsByWeek( const QDate date );
-    QVector<Event> eventsByDay( const QDate date );
+    /* cached years
+     * At program start, events may come from EventCache before the database is read.
+     * These years have no Appointment objects and no year marker. */
+    void addCachedEvents( const int inYear, const QVector<Event> &inEvents );
+    bool haveCachedYear( const int inYear ) const;
+    bool haveCachedEvents() const;
+    void dropCachedEvents();    // call before the database is read for these years
+    QList<int> markedYears() const;
+
+    /* Events
+     * inHiddenCalendars has a set bit for every user calendar id, whose events are left out,
+     *  see UserCalendarPool::hiddenCalendars(). Ids outside the array are visible. */
+    QVector<Event> eventsByYear( const int inYear, const QBitArray &inHiddenCalendars = QBitArray() ) const;
+    QVector<Event> eventsByYearMonth( const int inYear, const int inMonth, const QBitArray &inHiddenCalendars = QBitArray() ) const;
+    QVector<Event> eventsBy3Weeks( const QDate date, const QBitArray &inHiddenCalendars = QBitArray() );
+    QVector<Event> eventsByWeek( const QDate date, const QBitArray &inHiddenCalendars = QBitArray() );
+    QVector<Event> eventsByDay( const QDate date, const QBitArray &inHiddenCalendars = QBitArray() );
+
+    // events of all calendars without the streamed ones, for EventCache
+    QVector<Event> storedEventsByYear( const int inYear ) const;
+
+    /* Free/busy
+     * inUserCalendars has a set bit for every user calendar id to look at. The range is
+     *  inFirst 00:00 ... inLast 24:00 local time. The caller loads the years of the range
+     *  first, see MainWindow::loadYears(). inPublishedBusy are VFREEBUSY periods from
+     *  Storage::loadFreeBusyPeriods(), they count like appointments of their calendar.
+     * busyIntervals() are the merged, sorted times covered by appointments, which are
+     *  not FREE (TRANSP:TRANSPARENT), and by published periods. freeSlots() are the gaps
+     *  between them, which are at least inMinSecs long. */
+    QVector<FreeBusyInterval> busyIntervals( const QDate &inFirst, const QDate &inLast,
+                                             const QBitArray &inUserCalendars,
+                                             const QVector<FreeBusyPeriod> &inPublishedBusy ) const;
+    QVector<FreeBusyInterval> freeSlots( const QDate &inFirst, const QDate &inLast,
+                                         const QBitArray &inUserCalendars,
+                                         const QVector<FreeBusyPeriod> &inPublishedBusy, const qint64 inMinSecs ) const;
 
 
 private:
-    QVector<Appointment*>       m_appointments;
+    // no view shows more events of one sub-daily recurrence on a day
+    static const int MAX_STREAMED_EVENTS_PER_DAY = 96;
+
+    // user calendar id -> appointments of this calendar
+    QMap<int, QVector<Appointment*>>    m_appointments;
+
+    // uid -> appointment, for every appointment we have, no duplicates
+    QHash<QString, Appointment*>        m_appointmentsByUid;
+
+    // sub-daily recurrences, their events are made per request, see Appointment::isStreamed()
+    QVector<const Appointment*> m_streamedAppointments;
 
-    // set of uid, just to mark which ones we have, no duplicates.
-    QSet<QString>               m_appointmentsRead;
+    // uids of appointments, which do not make busy, for free/busy
+    QSet<QString>               m_freeAppointments;
 
     // set of years to make update easier, see above
     QSet<int>                   m_yearMarkers;
 
-    QMap<int, QVector<Event>>   m_eventMap; // year and event list
+    // years with events from EventCache only
+    QSet<int>                   m_cachedYears;
+
+    /* Interval index of one calendar and year: the events are sorted by start date, when a
+     *  query needs it. An event touching a range starts at most m_maxSpanDays before it. */
+    struct YearEvents
+    {
+        QVector<Event>  m_events;
+        int             m_maxSpanDays = 0;
+        bool            m_sorted = true;
+    };
+
+    // user calendar id -> year -> events. Events are stored in every year they touch.
+    // mutable: const queries sort the years they read
+    mutable QMap<int, QMap<int, YearEvents>>    m_partitions;
+
+    void addEvent( const Event &inEvent );
+    static void addToYear( YearEvents &inoutYear, const Event &inEvent );
+    static void removeFromYear( YearEvents &inoutYear, const QString &inUid );
+    static void appendEventsInRange( YearEvents &inoutYear, const QDate &inFirst, const QDate &inLast,
+                                     const bool inSkipEarlierYears, QVector<Event> &outEvents );
+    QVector<Event> eventsInRange( const QDate &inFirst, const QDate &inLast, const QBitArray &inHiddenCalendars ) const;
+    void appendStreamedEvents( const QDate &inFirst, const QDate &inLast, const QBitArray &inHiddenCalendars,
+                               QVector<Event> &outEvents ) const;
 };
 
 #endif // EVENTPOOL_H
@@ -14,129 +14,195 @@
     You should have received a copy of the GNU General Public License
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
-#include <QFile>
 #include "ui_icalimportdialog.h"
 #include "icalimportdialog.h"
 
+#include <QScrollBar>
+#include <QTextCursor>
 
-IcalImportDialog::IcalImportDialog( QWidget *parent ) :
+
+// content lines read into the preview at once
+static const int PREVIEW_PAGE_LINES = 200;
+// longer lines are cut in the preview
+static const int PREVIEW_MAX_LINE_BYTES = 1024;
+// older messages are dropped
+static const int MAX_MESSAGE_LINES = 1000;
+
+
+IcalImportDialog::IcalImportDialog( Storage* inStorage, QWidget *parent ) :
     QDialog( parent ),
-    m_ui( new Ui::IcalImportDialog )
+    m_ui( new Ui::IcalImportDialog ),
+    m_storage( inStorage ),
+    m_queue( nullptr ),
+    m_scheduler( nullptr ),
+    m_storageThread( nullptr ),
+    m_jobsFinished( false ),
+    m_storageFinished( false )
 {
     m_ui->setupUi( this );
+    m_ui->pbCancel->setEnabled( false );
+    m_ui->pteMessages->setMaximumBlockCount( MAX_MESSAGE_LINES );
+    connect( m_ui->pbCancel, SIGNAL(clicked()), this, SLOT(slotCancel()) );
+    connect( m_ui->comboPreviewFile, SIGNAL(currentIndexChanged(int)),
+             this, SLOT(slotPreviewFileChanged(int)) );
+    connect( m_ui->pteContent->verticalScrollBar(), SIGNAL(valueChanged(int)),
+             this, SLOT(slotPreviewScrolled(int)) );
 }
 
 
 IcalImportDialog::~IcalImportDialog()
 {
+    if( m_storageThread )
+    {
+        m_queue->close();
+        delete m_scheduler;     // interrupts and waits for the import threads
+        m_scheduler = nullptr;
+        m_storageThread->wait();
+    }
+    deleteThreadsAndData();
     delete m_ui;
 }
 
 
 void IcalImportDialog::setFilenames( QStringList &inList )
 {
+    if( ( m_storageThread and not m_storageThread->isFinished() ) or
+        ( m_scheduler and m_scheduler->isRunning() ) )
+    {
+        m_ui->pteMessages->appendPlainText( "* ERR: last import is still running" );
+        return;
+    }
     m_ui->pBarVEvents->reset();
     m_ui->pBarEvents->reset();
-    m_ui->teContent->clear();
-    m_ui->teMessages->clear();
+    m_ui->pteMessages->clear();
     deleteThreadsAndData();
-    int currentNum = 0;
-    for( const QString fn : inList )
-    {
-        QFile file( fn );
-        if( file.open( QIODevice::ReadOnly | QIODevice::Text ) )
-        {
+    // preview shows the first file
+    m_ui->comboPreviewFile->clear();
+    m_ui->comboPreviewFile->addItems( inList );
 
-            currentNum++;
-            QStringList lineList;
-            while( not file.atEnd() )
-            {
-                QString s = file.readLine();
-                if( s.isEmpty() )
-                    continue;
-                s.chop(1);          // remove last character '\n'
-                if( s.startsWith( ' ' ) )
-                {   // follow-up lines
-                    QString lastLine = lineList.last();
-                    lineList.removeLast();
-                    lastLine = lastLine.append( s.right(s.count() - 1 ) );
-                    lineList.append( lastLine );
-                    continue;
-                }
-                lineList.append( s );
-                m_ui->teContent->insertPlainText( s.append( '\n' ) );
-            }
-            file.close();
-            if( lineList.count() > 0 )
-                parseIcalFile( fn, lineList );
-        }
-    }
+    m_jobsFinished = false;
+    m_storageFinished = false;
+    m_queue = new AppointmentQueue();
+    m_storageThread = new ImportStorageThread( m_queue, m_storage->databaseName(), this );
+    connect( m_storageThread, SIGNAL(sigAppointmentStored(Appointment*)),
+             this, SIGNAL(sigAppointmentImported(Appointment*)) );
+    connect( m_storageThread, SIGNAL(sigBatchStored(int)),
+             this, SIGNAL(sigAppointmentsStored(int)) );
+    connect( m_storageThread, SIGNAL(finished()),
+             this, SLOT(slotStorageThreadFinished()) );
+    m_storageThread->start();
+
+    m_progress.fill( ImportProgress{ 0, 0, 0, 0, 0, 0 }, inList.count() );
+    m_scheduler = new ImportScheduler( m_queue, this );
+    connect( m_scheduler, SIGNAL(sigTickEvent(int,int,int,int)),
+             this, SLOT(slotTickEvent(int,int,int,int)) );
+    connect( m_scheduler, SIGNAL(sigTickVEvents(int,int,int,int)),
+             this, SLOT(slotTickVEvents(int,int,int,int)) );
+    connect( m_scheduler, SIGNAL(sigJobFinished(int)),
+             this, SLOT(slotJobFinished(int)) );
+    connect( m_scheduler, SIGNAL(sigAllFinished()),
+             this, SLOT(slotAllJobsFinished()) );
+    m_ui->pbCancel->setEnabled( true );
+    m_scheduler->start( inList, m_storage );
 }
 
 void IcalImportDialog::deleteThreadsAndData()
 {
-    for( const ThreadInfo ti : m_threads )
+    delete m_scheduler;
+    m_scheduler = nullptr;
+    if( m_storageThread )
     {
-        ti.thread->deleteLater();
+        m_storageThread->deleteLater();
+        m_storageThread = nullptr;
     }
-    m_threads.clear();
+    delete m_queue;
+    m_queue = nullptr;
+    m_progress.clear();
 }
 
 
-void IcalImportDialog::parseIcalFile( const QString inFilename, QStringList &inContentLines )
+void IcalImportDialog::readPreviewPage()
 {
-    m_ui->pBarEvents->reset();
-
-    ThreadInfo t;
-    t.thread = new IcalImportThread( m_threads.count(), inContentLines, this );
-    t.filename = inFilename;
-    t.v_min = 0, t.v_current = 0, t.v_max = 0;
-    t.e_min = 0, t.e_current = 0, t.e_max = 0;
-    t.ended = false;
-    t.successful = true;
-    m_threads.append( t );
-
-    connect( t.thread, SIGNAL(sigTickEvent(int,int,int,int)),
-             this, SLOT(slotTickEvent(int,int,int,int)) );
-    connect( t.thread, SIGNAL(sigTickVEvents(int,int,int,int)),
-             this, SLOT(slotTickVEvents(int,int,int,int)) );
-    connect( t.thread, SIGNAL(sigThreadFinished(int)),
-             this, SLOT(slotThreadFinished(int)) );
-    connect( t.thread, SIGNAL(sigWeDislikeIcalFile(int,int)),
-             this, SLOT(slotWeDislikeIcalFile(int,int)) );
-    t.thread->start();
+    if( not m_previewFile.isOpen() )
+        return;
+    QString page;
+    int numLines = 0;
+    while( numLines < PREVIEW_PAGE_LINES and not m_previewFile.atEnd() )
+    {
+        QByteArray line = m_previewFile.readLine( PREVIEW_MAX_LINE_BYTES );
+        if( not line.endsWith( '\n' ) and not m_previewFile.atEnd() )
+        {   // skip the rest of a long line
+            while( not m_previewFile.atEnd() and not m_previewFile.readLine( PREVIEW_MAX_LINE_BYTES ).endsWith( '\n' ) )
+                ;
+            line.append( "..." );
+        }
+        while( line.endsWith( '\n' ) or line.endsWith( '\r' ) )
+            line.chop( 1 );
+        if( numLines > 0 )
+            page.append( '\n' );
+        page.append( QString::fromUtf8( line ) );
+        numLines++;
+    }
+    if( m_previewFile.atEnd() )
+        m_previewFile.close();
+    if( numLines == 0 )
+        return;
+    // a cursor of its own does not scroll the view, appendPlainText() would and read the next page
+    QTextCursor cursor( m_ui->pteContent->document() );
+    cursor.movePosition( QTextCursor::End );
+    if( not m_ui->pteContent->document()->isEmpty() )
+        cursor.insertText( "\n" );
+    cursor.insertText( page );
 }
 
 
-void IcalImportDialog::displayContentToMessage()
+void IcalImportDialog::displaySummary()
 {
-    for( const ThreadInfo mi : m_threads )
+    int numImported = 0, numAppointments = 0, numSkippedVEvents = 0;
+    int numUnchanged = 0, numFailed = 0, numCancelled = 0;
+    for( const ImportScheduler::ImportJob &job : m_scheduler->jobs() )
     {
-        if( mi.successful )
+        switch( job.m_state )
         {
-            m_ui->teMessages->insertPlainText( QString( "=== %1 ===\n" ).arg(mi.filename) );
-
-            for( const Appointment* app : mi.thread->m_appointments )
-            {
-                m_ui->teMessages->insertPlainText(
-                            app->m_appBasics->contententToString() );
-            }
+            case ImportScheduler::JS_DONE:
+                numImported++;
+                numAppointments += job.m_numAppointments;
+                numSkippedVEvents += job.m_numSkippedVEvents;
+            break;
+            case ImportScheduler::JS_UNCHANGED:
+                numUnchanged++;
+            break;
+            case ImportScheduler::JS_FAILED:
+                numFailed++;
+            break;
+            case ImportScheduler::JS_CANCELLED:
+                numCancelled++;
+            break;
+            default:
+            break;
         }
     }
+    m_ui->pteMessages->appendPlainText(
+                QString( "=== %1 files imported: %2 appointments, %3 VEVENTs unchanged ===" )
+                .arg( numImported ).arg( numAppointments ).arg( numSkippedVEvents ) );
+    if( numUnchanged > 0 )
+        m_ui->pteMessages->appendPlainText( QString( "=== %1 files unchanged since last import ===" ).arg( numUnchanged ) );
+    if( numFailed > 0 or numCancelled > 0 )
+        m_ui->pteMessages->appendPlainText( QString( "=== %1 files failed, %2 cancelled ===" ).arg( numFailed ).arg( numCancelled ) );
 }
 
 
 void IcalImportDialog::slotTickEvent( const int threadId, int min, int current, int max )
 {
-    m_threads[threadId].e_min = min;
-    m_threads[threadId].e_current = current;
-    m_threads[threadId].e_max = max;
+    m_progress[threadId].e_min = min;
+    m_progress[threadId].e_current = current;
+    m_progress[threadId].e_max = max;
     int smin = 0, scurrent = 0, smax = 0;
-    for( const ThreadInfo ti : m_threads )
+    for( const ImportProgress &p : m_progress )
     {
-        smin += ti.e_min;
-        scurrent += ti.e_current;
-        smax += ti.e_max;
+        smin += p.e_min;
+        scurrent += p.e_current;
+        smax += p.e_max;
     }
     m_ui->pBarEvents->setRange( smin, smax );
     m_ui->pBarEvents->setValue( scurrent );
@@ -145,53 +211,112 @@ void IcalImportDialog::slotTickEvent( const int threadId, int min, int current,
 
 void IcalImportDialog::slotTickVEvents( const int threadId, int min, int current, int max )
 {
-    m_threads[threadId].v_min = min;
-    m_threads[threadId].v_current = current;
-    m_threads[threadId].v_max = max;
+    m_progress[threadId].v_min = min;
+    m_progress[threadId].v_current = current;
+    m_progress[threadId].v_max = max;
 
     int smin = 0, scurrent = 0, smax = 0;
-    for( const ThreadInfo ti : m_threads )
+    for( const ImportProgress &p : m_progress )
     {
-        smin += ti.v_min;
-        scurrent += ti.v_current;
-        smax += ti.v_max;
+        smin += p.v_min;
+        scurrent += p.v_current;
+        smax += p.v_max;
     }
     m_ui->pBarVEvents->setRange( smin, smax );
     m_ui->pBarVEvents->setValue( scurrent );
 }
 
 
-void IcalImportDialog::slotThreadFinished( const int threadId )
+void IcalImportDialog::slotJobFinished( const int id )
+{
+    // only problems are listed, successful files are summed up by displaySummary()
+    const ImportScheduler::ImportJob &job = m_scheduler->jobs().at( id );
+    switch( job.m_state )
+    {
+        case ImportScheduler::JS_FAILED:
+            if( static_cast<IcalImportThread::IcalDislikeReasonType>(job.m_dislikeReason) ==
+                    IcalImportThread::IcalDislikeReasonType::NOT_READABLE )
+                m_ui->pteMessages->appendPlainText( QString( "* ERR: %1 is not readable" ).arg( job.m_filename ) );
+            else
+                m_ui->pteMessages->appendPlainText( QString( "* ERR: %1 does not validate" ).arg( job.m_filename ) );
+        break;
+        case ImportScheduler::JS_CANCELLED:
+            m_ui->pteMessages->appendPlainText( QString( "* ERR: %1 cancelled" ).arg( job.m_filename ) );
+        break;
+        default:
+        break;
+    }
+}
+
+
+void IcalImportDialog::slotAllJobsFinished()
+{
+    // storage thread stores the rest and finishes
+    m_ui->pbCancel->setEnabled( false );
+    m_queue->close();
+    qDebug() << "Threads are finished";
+    m_jobsFinished = true;
+    if( m_storageFinished )
+        finishImport();
+}
+
+
+void IcalImportDialog::slotStorageThreadFinished()
 {
-    qDebug() << "I should delete " << threadId ;
-    m_threads[threadId].ended = true;
-    if( m_threads[threadId].successful )
-        m_ui->teMessages->insertPlainText(
-                    QString( "* OK: %1 finished\n" )
-                    .arg( m_threads[threadId].filename ) );
-    bool allThreadsAreFinished = true;
-    for( const ThreadInfo ti : m_threads )
+    m_storageFinished = true;
+    if( m_jobsFinished )
+        finishImport();
+}
+
+
+/* After a cancel, the storage thread may finish before the import threads,
+ *  so the job states are final only when both are finished. */
+void IcalImportDialog::finishImport()
+{
+    // everything is stored, so remember the files for the next import
+    for( const ImportScheduler::ImportJob &job : m_scheduler->jobs() )
     {
-        if( not ti.ended )
+        if( job.m_state == ImportScheduler::JS_DONE )
         {
-            allThreadsAreFinished = false;
-            break;
+            m_storage->setImportHashes( job.m_filename, job.m_fileHash, job.m_vEventHashes );
+            m_storage->setFreeBusyPeriods( job.m_filename, job.m_freeBusyPeriods );
         }
     }
-    if( allThreadsAreFinished )
+    displaySummary();
+    emit sigFinishReadingFiles();
+}
+
+
+void IcalImportDialog::slotCancel()
+{
+    if( m_scheduler == nullptr )
+        return;
+    m_ui->pbCancel->setEnabled( false );
+    m_scheduler->cancel();
+    // threads blocked in a full queue give up, the storage thread stores what is there
+    m_queue->close();
+}
+
+
+void IcalImportDialog::slotPreviewFileChanged( int index )
+{
+    m_previewFile.close();
+    m_ui->pteContent->clear();
+    if( index < 0 )
+        return;
+    m_previewFile.setFileName( m_ui->comboPreviewFile->itemText( index ) );
+    if( not m_previewFile.open( QIODevice::ReadOnly ) )
     {
-        emit sigFinishReadingFiles();
-        qDebug() << "Threads are finished";
-        displayContentToMessage();
+        m_ui->pteContent->appendPlainText( "* ERR: file is not readable" );
+        return;
     }
+    readPreviewPage();
 }
 
 
-void IcalImportDialog::slotWeDislikeIcalFile( const int threadId, const int reason )
+void IcalImportDialog::slotPreviewScrolled( int value )
 {
-    m_threads[threadId].successful = false;
-    if( static_cast<IcalImportThread::IcalDislikeReasonType>(reason) == IcalImportThread::IcalDislikeReasonType::DOES_NOT_VALIDATE )
-        m_ui->teMessages->insertPlainText(
-                    QString( "* ERR: %1 does not validate\n" )
-                    .arg( m_threads[threadId].filename ) );
+    // next page, when the end is reached
+    if( value == m_ui->pteContent->verticalScrollBar()->maximum() )
+        readPreviewPage();
 }
@@ -18,10 +18,14 @@
 #define ICALIMPORTDIALOG_H
 
 #include "appointmentmanager.h"
-#include "icalimportthread.h"
+#include "appointmentqueue.h"
+#include "importscheduler.h"
+#include "importstoragethread.h"
+#include "storage.h"
 
 #include <QDebug>
 #include <QDialog>
+#include <QFile>
 #include <QStringList>
 #include <QVector>
 
@@ -29,46 +33,67 @@ namespace Ui {
     class IcalImportDialog;
 }
 
-struct ThreadInfo
+// progress of one file, summed up for the progress bars
+struct ImportProgress
 {
-    IcalImportThread* thread;
-    QString filename;
-    // processing VEvents inside of thread, used for progressbar
+    // processing VEvents inside of thread
     int v_min, v_current, v_max;
-    // generating Events inside of thread, used for progressbar
+    // generating Events inside of thread
     int e_min, e_current, e_max;
-    // end of thread
-    bool ended;
-    // unsuccessful: false
-    bool successful;
 };
 
+/* Dialog showing the progress of an ical import.
+ * The import is a pipeline: ImportScheduler runs an IcalImportThread per file on a bounded
+ *  number of threads. They read, parse, interpret and expand the files into appointments,
+ *  which go through a bounded AppointmentQueue to one ImportStorageThread writing them into
+ *  the database. Stored appointments are forwarded with sigAppointmentImported(), so the
+ *  receiver can show them while the import runs.
+ * sigFinishReadingFiles() is sent, when the last appointment is stored and all import threads
+ *  are finished.
+ * Files and VEVENTs, which did not change since the last import, are skipped. The
+ *  hashes to decide this are kept in Storage.
+ * Cancel stops the whole import. What is stored until then stays in the database.
+ * The dialog does not depend on the size of the files: the content preview reads a page
+ *  of lines whenever it is scrolled to the end, the message log lists failed files and
+ *  sums up the rest. */
 class IcalImportDialog : public QDialog
 {
     Q_OBJECT
 
 public:
-    explicit IcalImportDialog(QWidget *parent = 0);
+    explicit IcalImportDialog(Storage* inStorage, QWidget *parent = 0);
     ~IcalImportDialog();
     void setFilenames( QStringList &inList );
     void deleteThreadsAndData();
 
-    QVector<ThreadInfo>     m_threads;
-
-
 private:
     Ui::IcalImportDialog*   m_ui;
-    void parseIcalFile( const QString inFilename, QStringList &inContentLines );
-    void displayContentToMessage();
+    Storage*                m_storage;          // knows hashes of files imported before
+    AppointmentQueue*       m_queue;            // between import threads and storage thread
+    ImportScheduler*        m_scheduler;        // runs the import threads
+    ImportStorageThread*    m_storageThread;    // last stage of the import pipeline
+    QVector<ImportProgress> m_progress;         // by job id of m_scheduler
+    QFile                   m_previewFile;      // file in the content preview, open while not read to the end
+    bool                    m_jobsFinished;     // sigAllFinished() of m_scheduler arrived
+    bool                    m_storageFinished;  // m_storageThread is finished
+    void readPreviewPage();
+    void displaySummary();
+    void finishImport();                        // once both, jobs and storage, are finished
 
 signals:
     void sigFinishReadingFiles();
+    void sigAppointmentImported( Appointment* app );    // receiver owns app
+    void sigAppointmentsStored( const int numStored );
 
 private slots:
     void slotTickEvent( const int id, int min, int current, int max );
     void slotTickVEvents( const int id, int min, int current, int max );
-    void slotThreadFinished( const int id );
-    void slotWeDislikeIcalFile( const int threadId, const int reason );
+    void slotJobFinished( const int id );
+    void slotAllJobsFinished();
+    void slotStorageThreadFinished();
+    void slotCancel();
+    void slotPreviewFileChanged( int index );
+    void slotPreviewScrolled( int value );
 };
 
 #endif // ICALIMPORTDIALOG_H
@@ -16,14 +16,30 @@
 */
 #include "icalimportthread.h"
 
+#include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QFile>
 
+#include <cstring>
 
-IcalImportThread::IcalImportThread(const int inThreadId, const QStringList &inContentLines, QObject* parent )
+
+IcalImportThread::IcalImportThread( const int inThreadId, const QString &inFilename,
+                                    const QByteArray &inKnownFileHash,
+                                    const QSet<QByteArray> &inKnownVEventHashes,
+                                    AppointmentQueue* inQueue, QSemaphore* inThreadBudget,
+                                    QObject* parent )
     :
       QThread(parent),
+      m_unchanged(false),
+      m_numAppointments(0),
+      m_numSkippedVEvents(0),
       m_threadId(inThreadId),
-      m_contentLines( inContentLines )
+      m_filename( inFilename ),
+      m_knownFileHash( inKnownFileHash ),
+      m_knownVEventHashes( inKnownVEventHashes ),
+      m_queue( inQueue ),
+      m_threadBudget( inThreadBudget )
 {
     // we connect this insode of this class, because we want append
     // the threadID
@@ -31,17 +47,123 @@ IcalImportThread::IcalImportThread(const int inThreadId, const QStringList &inCo
 }
 
 
+// a VEVENT is the content lines m_first ... m_last, BEGIN and END included
+struct VEventRange
+{
+    int m_first;
+    int m_last;
+};
+
+
+// VEVENTs m_firstRange ... m_endRange - 1, read into an ICalBody of their own
+struct VEventChunk
+{
+    int             m_firstRange;
+    int             m_endRange;
+    ICalBody        m_body;
+    QVector<QPair<QByteArray, QString>>  m_vEventHashes;
+    int             m_numSkippedVEvents;
+};
+
+
+// files with less VEVENTs are read by a single thread, more VEVENTs make more chunks
+static const int MIN_VEVENTS_PER_CHUNK = 1000;
+
+
+/* reads one chunk of VEVENTs as helper of an IcalImportThread. The content lines
+ *  and ranges are only read by all the chunks, so they can share them. */
+class VEventChunkThread : public QThread
+{
+public:
+    VEventChunkThread( IcalImportThread* inImportThread, const QStringList &inLines,
+                       const QVector<VEventRange> &inRanges, VEventChunk &inChunk )
+        : m_importThread( inImportThread ), m_lines( inLines ), m_ranges( inRanges ), m_chunk( inChunk ) {}
+
+    void run() override
+    {
+        m_importThread->readVEventChunk( m_lines, m_ranges, m_chunk );
+    }
+
+private:
+    IcalImportThread*           m_importThread;
+    const QStringList           &m_lines;
+    const QVector<VEventRange>  &m_ranges;
+    VEventChunk                 &m_chunk;
+};
+
+
+void IcalImportThread::readVEventChunk( const QStringList &inLines, const QVector<VEventRange> &inRanges,
+                                        VEventChunk &inoutChunk ) const
+{
+    for( int r = inoutChunk.m_firstRange; r < inoutChunk.m_endRange; r++ )
+    {
+        if( isInterruptionRequested() )
+            return;
+        // hash the VEVENT and read it only if it is new or changed
+        const VEventRange &range = inRanges.at( r );
+        QCryptographicHash hash( QCryptographicHash::Sha1 );
+        hash.addData( m_vTimezonesHash );
+        QString uid;
+        for( int i = range.m_first; i <= range.m_last; i++ )
+        {
+            const QString &line = inLines.at( i );
+            hash.addData( line.toUtf8() );
+            hash.addData( "\n" );
+            if( line.startsWith( "UID", Qt::CaseInsensitive ) and
+                ( line.midRef( 3, 1 ) == ":" or line.midRef( 3, 1 ) == ";" ) )
+            {
+                // parameter values may be quoted and contain ':'
+                QString name;
+                QStringList parameters;
+                Property::splitParts( line, name, uid, parameters );
+            }
+        }
+        QByteArray vEventHash = hash.result().toHex();
+        inoutChunk.m_vEventHashes.append( qMakePair( vEventHash, uid ) );
+        if( m_knownVEventHashes.contains( vEventHash ) )
+            inoutChunk.m_numSkippedVEvents++;
+        else
+        {
+            for( int i = range.m_first; i <= range.m_last; i++ )
+                inoutChunk.m_body.readContentLine( inLines.at( i ) );
+        }
+    }
+}
+
+
 void IcalImportThread::run()
 {
+    if( not readContentLines( m_filename, m_contentLines ) )
+    {
+        emit sigWeDislikeIcalFile( m_threadId, static_cast<int>(IcalDislikeReasonType::NOT_READABLE) );
+        return;
+    }
+    m_fileHash = contentLinesHash( m_contentLines );
+    if( m_fileHash == m_knownFileHash )
+    {
+        m_unchanged = true;
+        m_contentLines.clear();
+        return;
+    }
+
     ICalBody vcal;
     IcalInterpreter interpreter;
 
-    // read content lines and build up ICalBody
+    /* pre-scan: calendar properties and all components except VEVENTs are read right
+     *  away, VEVENTs are just located. They are the bulk of a file and independent
+     *  of each other, so they are read afterwards, in parallel chunks for big files. */
+    const QStringList &lines = m_contentLines;
+    QVector<VEventRange> vEventRanges;
+    QCryptographicHash vTimezonesHash( QCryptographicHash::Sha1 );
+    bool haveVTimezones = false;
+    bool inVTimezone = false;
     bool startOfReadingCalfile = false;
-    while( not m_contentLines.isEmpty() )
+    int vEventFirst = -1;
+    for( int i = 0; i < lines.count(); i++ )
     {
-        QString contentLine = m_contentLines.first();
-        m_contentLines.removeFirst();
+        if( isInterruptionRequested() )
+            return;
+        const QString &contentLine = lines.at( i );
 
         if( contentLine.compare( "BEGIN:VCALENDAR", Qt::CaseInsensitive ) == 0 )
         {
@@ -55,11 +177,79 @@ void IcalImportThread::run()
             continue;
         }
 
-        if( startOfReadingCalfile )
+        if( not startOfReadingCalfile )
+            continue;
+
+        if( contentLine.compare( "BEGIN:VEVENT", Qt::CaseInsensitive ) == 0 )
+            vEventFirst = i;
+        if( vEventFirst >= 0 )
+        {
+            if( contentLine.compare( "END:VEVENT", Qt::CaseInsensitive ) == 0 )
+            {
+                vEventRanges.append( VEventRange{ vEventFirst, i } );
+                vEventFirst = -1;
+            }
+            continue;
+        }
+
+        // VEVENTs with times in a changed VTIMEZONE have to be read again
+        if( contentLine.compare( "BEGIN:VTIMEZONE", Qt::CaseInsensitive ) == 0 )
+            inVTimezone = haveVTimezones = true;
+        if( inVTimezone )
         {
-            vcal.readContentLine( contentLine );
+            vTimezonesHash.addData( contentLine.toUtf8() );
+            vTimezonesHash.addData( "\n" );
+            if( contentLine.compare( "END:VTIMEZONE", Qt::CaseInsensitive ) == 0 )
+                inVTimezone = false;
         }
+
+        vcal.readContentLine( contentLine );
     }
+    if( haveVTimezones )
+        m_vTimezonesHash = vTimezonesHash.result().toHex();
+
+    // read VEVENTs, the last chunk in this thread, the others in helpers from the budget
+    const int wantedChunks = qMax( 1, vEventRanges.count() / MIN_VEVENTS_PER_CHUNK );
+    int numHelpers = 0;
+    while( m_threadBudget != nullptr and numHelpers < wantedChunks - 1 and m_threadBudget->tryAcquire() )
+        numHelpers++;
+    const int numChunks = numHelpers + 1;
+    QVector<VEventChunk> chunks( numChunks );
+    for( int c = 0; c < numChunks; c++ )
+    {
+        chunks[c].m_firstRange = vEventRanges.count() * c / numChunks;
+        chunks[c].m_endRange = vEventRanges.count() * ( c + 1 ) / numChunks;
+        chunks[c].m_numSkippedVEvents = 0;
+    }
+    QVector<VEventChunkThread*> chunkThreads;
+    for( int c = 0; c < numChunks - 1; c++ )
+    {
+        chunkThreads.append( new VEventChunkThread( this, lines, vEventRanges, chunks[c] ) );
+        chunkThreads.last()->start();
+    }
+    readVEventChunk( lines, vEventRanges, chunks.last() );
+    for( VEventChunkThread* t : chunkThreads )
+    {
+        t->wait();
+        delete t;
+    }
+    if( numHelpers > 0 )
+    {
+        m_threadBudget->release( numHelpers );
+        emit sigHelperThreadsDone( m_threadId );
+    }
+    if( isInterruptionRequested() )
+        return;
+
+    // merge the chunks in file order
+    for( const VEventChunk &chunk : chunks )
+    {
+        vcal.m_vEventComponents += chunk.m_body.m_vEventComponents;
+        m_vEventHashes += chunk.m_vEventHashes;
+        m_numSkippedVEvents += chunk.m_numSkippedVEvents;
+    }
+    chunks.clear();
+    m_contentLines.clear();
 
     // validate
     if( not vcal.validateIcal() )
@@ -74,9 +264,65 @@ void IcalImportThread::run()
              this, SLOT(slotTickEvent(int,int,int)) );
     connect( &interpreter, SIGNAL(sigTickVEvents(int,int,int)),
              this, SLOT(slotTickVEvents(int,int,int)) );
+    // direct connection: push() has to block this thread, if the queue is full
     connect( &interpreter, SIGNAL( sigAppointmentReady(Appointment*)),
-             this, SLOT( slotAppointmentReady(Appointment*)) );
+             this, SLOT( slotAppointmentReady(Appointment*)), Qt::DirectConnection );
     interpreter.readIcal( vcal );
+    m_freeBusyPeriods = interpreter.freeBusyPeriods();
+}
+
+
+bool IcalImportThread::readContentLines( const QString &inFilename, QStringList &outContentLines )
+{
+    QFile file( inFilename );
+    if( not file.open( QIODevice::ReadOnly ) )
+        return false;
+
+    // a mapped file saves copying everything through the buffers of QFile
+    qint64 size = file.size();
+    const char* data = size > 0 ? reinterpret_cast<const char*>( file.map( 0, size ) ) : nullptr;
+    QByteArray contents;
+    if( data == nullptr )
+    {
+        contents = file.readAll();
+        data = contents.constData();
+        size = contents.size();
+    }
+
+    const char* lineStart = data;
+    const char* const end = data + size;
+    while( lineStart < end )
+    {
+        const char* lineEnd = static_cast<const char*>( memchr( lineStart, '\n', end - lineStart ) );
+        const char* next = lineEnd ? lineEnd + 1 : end;
+        if( lineEnd == nullptr )
+            lineEnd = end;
+        if( lineEnd > lineStart and lineEnd[-1] == '\r' )
+            lineEnd--;
+        const int length = static_cast<int>( lineEnd - lineStart );
+        if( length > 0 )
+        {
+            if( ( *lineStart == ' ' or *lineStart == '\t' ) and not outContentLines.isEmpty() )
+                outContentLines.last().append( QString::fromUtf8( lineStart + 1, length - 1 ) );   // follow-up line
+            else
+                outContentLines.append( QString::fromUtf8( lineStart, length ) );
+        }
+        lineStart = next;
+    }
+    file.close();
+    return true;
+}
+
+
+QByteArray IcalImportThread::contentLinesHash( const QStringList &inContentLines )
+{
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    for( const QString &line : inContentLines )
+    {
+        hash.addData( line.toUtf8() );
+        hash.addData( "\n" );
+    }
+    return hash.result().toHex();
 }
 
 
@@ -96,8 +342,17 @@ void IcalImportThread::slotTickVEvents( const int min, const int current, const
 
 void IcalImportThread::slotAppointmentReady(Appointment *app )
 {
-    // store the appointment
-    m_appointments.append( app );
+    if( isInterruptionRequested() )
+    {
+        delete app;
+        return;
+    }
+    // the appointment ends up in the gui thread, so hand it over while we own it
+    app->moveToThread( QCoreApplication::instance()->thread() );
+    if( m_queue->push( app ) )
+        m_numAppointments++;
+    else
+        delete app;     // import was cancelled
 }
 
 
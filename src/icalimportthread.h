@@ -17,20 +17,30 @@
 #ifndef ICALIMPORTTHREAD_H
 #define ICALIMPORTTHREAD_H
 
+#include <QByteArray>
+#include <QPair>
+#include <QSemaphore>
+#include <QSet>
 #include <QStringList>
 #include <QThread>
 #include <QVector>
 #include <QDateTime>
 
 #include "appointmentmanager.h"
+#include "appointmentqueue.h"
 #include "../icalreader/icalbody.h"
 #include "../icalreader/icalinterpreter.h"
 
 
 /* Import thread reads a given Ical-File and creates appointment Data out of it.
- * This is a threaded version controlled by someone, who splitted the file already
- *  into content lines, where follow-up lines are merged.
- * The Appointment data is then ready in m_appointments.
+ * The file is read inside of the thread into content lines, where follow-up lines are
+ *  merged. If the hash over these lines is inKnownFileHash, the file did not change
+ *  since the last import and is not parsed at all.
+ * Each generated Appointment is pushed into the given AppointmentQueue, where the
+ *  next stage picks it up while we are still parsing.
+ * Every VEVENT gets a hash over its content lines and the VTIMEZONEs of the file, as
+ *  its times depend on them. VEVENTs with a hash found in inKnownVEventHashes were
+ *  imported unchanged before and are not read again.
  *
  * There are several information services generated for the outside world:
  *  - sigTickEvent generates a progress counter for each generated Event.
@@ -40,8 +50,19 @@
  *
  *  - sigThreadFinished - thread is finished generating Appointments
  *  - sigWeDislikeIcalFile - there is something wrong with the ical file
+ *
+ * Big files read their VEVENTs with helper threads. Each helper takes a permit from
+ *  inThreadBudget, which is shared with the owner of the import threads, so all of
+ *  them together do not exceed its limit. Without a free permit, or if inThreadBudget
+ *  is nullptr, the VEVENTs are read in this thread alone. Returned permits are
+ *  signalled with sigHelperThreadsDone.
+ *
+ * requestInterruption() stops reading and interpreting as soon as possible.
  */
 
+struct VEventRange;
+struct VEventChunk;
+
 class IcalImportThread : public QThread
 {
     Q_OBJECT
@@ -49,21 +70,53 @@ class IcalImportThread : public QThread
 public:
     // reasons to dislike the ical file
     enum class IcalDislikeReasonType : int {
-        DOES_NOT_VALIDATE = 100
+        DOES_NOT_VALIDATE = 100,
+        NOT_READABLE = 101
     };
 
-    // constructor, reads ical file as content lines.
-    explicit IcalImportThread( const int inThreadId, const QStringList &inContentLines, QObject* parent = Q_NULLPTR );
+    // constructor, the file is read later inside of run()
+    explicit IcalImportThread( const int inThreadId, const QString &inFilename,
+                               const QByteArray &inKnownFileHash,
+                               const QSet<QByteArray> &inKnownVEventHashes,
+                               AppointmentQueue* inQueue, QSemaphore* inThreadBudget,
+                               QObject* parent = Q_NULLPTR );
 
     // fires up the thread generating Events
     void run() override;
 
-    // Thats what we get: Appointments
-    QVector<Appointment*>   m_appointments;
+    /* reads an ical file as content lines, follow-up lines are merged.
+     * Returns false, if the file is not readable. */
+    static bool readContentLines( const QString &inFilename, QStringList &outContentLines );
+    // hash over all content lines, the file hash of Storage::importFileHash()
+    static QByteArray contentLinesHash( const QStringList &inContentLines );
+
+    /* hashes and reads the VEVENTs of one chunk into its ICalBody. Big files are read
+     *  in several chunks at the same time, this runs in the helper threads, too. */
+    void readVEventChunk( const QStringList &inLines, const QVector<VEventRange> &inRanges,
+                          VEventChunk &inoutChunk ) const;
+
+    // hash over the content lines, valid as soon as the file is read
+    QByteArray      m_fileHash;
+    // true, if m_fileHash is the known one and nothing was parsed
+    bool            m_unchanged;
+    // number of appointments pushed into the queue
+    int             m_numAppointments;
+    // number of VEVENTs not read, because they are known
+    int             m_numSkippedVEvents;
+    // hash and uid of every VEVENT in this file, known or not
+    QVector<QPair<QByteArray, QString>>  m_vEventHashes;
+    // busy periods of the VFREEBUSY components, valid when the thread is through
+    QVector<FreeBusyPeriod>  m_freeBusyPeriods;
 
 private:
-    int             m_threadId;
-    QStringList     m_contentLines;
+    int                 m_threadId;
+    QString             m_filename;
+    QByteArray          m_knownFileHash;
+    QStringList         m_contentLines;
+    QByteArray          m_vTimezonesHash;   // over all VTIMEZONE lines, empty without any
+    QSet<QByteArray>    m_knownVEventHashes;
+    AppointmentQueue*   m_queue;
+    QSemaphore*         m_threadBudget;
 
 signals:
     // an event was generated
@@ -72,6 +125,9 @@ signals:
     // a VEVENT was read
     void sigTickVEvents( const int threadID, const int min, const int current, const int max );
 
+    // helper threads are through, their permits are back in the thread budget
+    void sigHelperThreadsDone( const int threadID );
+
     // we are finished
     void sigThreadFinished( const int threadID );
 
@@ -82,7 +138,7 @@ signals:
 public slots:
     void slotTickEvent( const int min, const int current, const int max );
     void slotTickVEvents( const int min, const int current, const int max );
-    // get an appointment and store this in m_appointments
+    // get an appointment and push it into m_queue. Runs inside of this thread.
     void slotAppointmentReady( Appointment* app );
     void slotThreadFinished();
 };
@@ -0,0 +1,197 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "importscheduler.h"
+
+#include <QFileInfo>
+#include <QThread>
+
+#include <algorithm>
+
+
+ImportScheduler::ImportScheduler( AppointmentQueue* inQueue, QObject* parent )
+    :
+      QObject( parent ),
+      m_queue( inQueue ),
+      m_storage( nullptr ),
+      m_nextJob( 0 ),
+      m_numRunning( 0 ),
+      m_maxThreads( qMax( 1, QThread::idealThreadCount() ) )
+{
+}
+
+
+ImportScheduler::~ImportScheduler()
+{
+    for( const ImportJob &job : m_jobs )
+    {
+        if( job.m_thread )
+            job.m_thread->requestInterruption();
+    }
+    for( const ImportJob &job : m_jobs )
+    {
+        if( job.m_thread )
+        {
+            job.m_thread->wait();
+            delete job.m_thread;
+        }
+    }
+}
+
+
+void ImportScheduler::setMaxThreads( const int inMaxThreads )
+{
+    m_maxThreads = qMax( 1, inMaxThreads );
+}
+
+
+int ImportScheduler::maxThreads() const
+{
+    return m_maxThreads;
+}
+
+
+void ImportScheduler::start( const QStringList &inFilenames, Storage* inStorage )
+{
+    m_storage = inStorage;
+    m_jobs.clear();
+    m_nextJob = 0;
+    // nothing runs, so every thread of the last start() is back
+    m_threadBudget.acquire( m_threadBudget.available() );
+    m_threadBudget.release( m_maxThreads );
+    for( const QString &fn : inFilenames )
+    {
+        ImportJob job;
+        job.m_filename = fn;
+        job.m_fileSize = QFileInfo( fn ).size();
+        job.m_state = JS_WAITING;
+        job.m_dislikeReason = 0;
+        job.m_numAppointments = 0;
+        job.m_numSkippedVEvents = 0;
+        job.m_thread = nullptr;
+        m_jobs.append( job );
+    }
+    std::stable_sort( m_jobs.begin(), m_jobs.end(),
+                      []( const ImportJob &a, const ImportJob &b ) { return a.m_fileSize > b.m_fileSize; } );
+
+    startWaitingJobs();
+    if( m_numRunning == 0 )
+        emit sigAllFinished();
+}
+
+
+void ImportScheduler::cancel()
+{
+    for( ; m_nextJob < m_jobs.count(); m_nextJob++ )
+        m_jobs[m_nextJob].m_state = JS_CANCELLED;
+    for( const ImportJob &job : m_jobs )
+    {
+        if( job.m_thread )
+            job.m_thread->requestInterruption();
+    }
+}
+
+
+bool ImportScheduler::isRunning() const
+{
+    return m_numRunning > 0;
+}
+
+
+const QVector<ImportScheduler::ImportJob> &ImportScheduler::jobs() const
+{
+    return m_jobs;
+}
+
+
+void ImportScheduler::startWaitingJobs()
+{
+    while( m_nextJob < m_jobs.count() and m_threadBudget.tryAcquire() )
+    {
+        ImportJob &job = m_jobs[m_nextJob];
+        // hashes are asked for late, so only the running jobs hold them
+        QByteArray knownFileHash;
+        QSet<QByteArray> knownVEventHashes;
+        if( m_storage )
+        {
+            knownFileHash = m_storage->importFileHash( job.m_filename );
+            knownVEventHashes = m_storage->importVEventHashes( job.m_filename );
+        }
+        job.m_thread = new IcalImportThread( m_nextJob, job.m_filename, knownFileHash,
+                                             knownVEventHashes, m_queue, &m_threadBudget, this );
+        job.m_state = JS_RUNNING;
+        connect( job.m_thread, SIGNAL(sigTickEvent(int,int,int,int)),
+                 this, SIGNAL(sigTickEvent(int,int,int,int)) );
+        connect( job.m_thread, SIGNAL(sigTickVEvents(int,int,int,int)),
+                 this, SIGNAL(sigTickVEvents(int,int,int,int)) );
+        connect( job.m_thread, SIGNAL(sigWeDislikeIcalFile(int,int)),
+                 this, SLOT(slotWeDislikeIcalFile(int,int)) );
+        connect( job.m_thread, SIGNAL(sigThreadFinished(int)),
+                 this, SLOT(slotThreadFinished(int)) );
+        connect( job.m_thread, SIGNAL(sigHelperThreadsDone(int)),
+                 this, SLOT(slotHelperThreadsDone(int)) );
+        job.m_thread->start();
+        m_numRunning++;
+        m_nextJob++;
+    }
+}
+
+
+void ImportScheduler::slotThreadFinished( const int jobId )
+{
+    ImportJob &job = m_jobs[jobId];
+    IcalImportThread* thread = job.m_thread;
+    if( thread == nullptr )
+        return;
+    thread->wait();
+    job.m_thread = nullptr;
+    job.m_fileHash = thread->m_fileHash;
+    job.m_vEventHashes = thread->m_vEventHashes;
+    job.m_freeBusyPeriods = thread->m_freeBusyPeriods;
+    job.m_numAppointments = thread->m_numAppointments;
+    job.m_numSkippedVEvents = thread->m_numSkippedVEvents;
+    if( job.m_state == JS_RUNNING )
+    {
+        if( thread->isInterruptionRequested() )
+            job.m_state = JS_CANCELLED;
+        else if( thread->m_unchanged )
+            job.m_state = JS_UNCHANGED;
+        else
+            job.m_state = JS_DONE;
+    }
+    thread->deleteLater();
+    m_numRunning--;
+    m_threadBudget.release();
+
+    emit sigJobFinished( jobId );
+    startWaitingJobs();
+    if( m_numRunning == 0 )
+        emit sigAllFinished();
+}
+
+
+/* the helpers of a big file are through, their threads can run waiting files */
+void ImportScheduler::slotHelperThreadsDone( const int /*jobId*/ )
+{
+    startWaitingJobs();
+}
+
+
+void ImportScheduler::slotWeDislikeIcalFile( const int jobId, const int reason )
+{
+    m_jobs[jobId].m_state = JS_FAILED;
+    m_jobs[jobId].m_dislikeReason = reason;
+}
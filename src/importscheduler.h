@@ -0,0 +1,117 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef IMPORTSCHEDULER_H
+#define IMPORTSCHEDULER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QPair>
+#include <QSemaphore>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "appointmentqueue.h"
+#include "icalimportthread.h"
+#include "storage.h"
+
+
+/* Runs the IcalImportThreads of a multi file import on a bounded number of threads.
+ * Files are queued largest first, so a big file does not start last and parse alone,
+ *  while the small ones are done long ago. At most maxThreads() files are read and
+ *  parsed at the same time, the next one starts when one of them is through.
+ * Big files read with helper threads. These take their permits from the same thread
+ *  budget, so there are never more than maxThreads() threads altogether.
+ * All threads push into the same AppointmentQueue. The owner closes the queue after
+ *  sigAllFinished(), or earlier to cancel.
+ * cancel() drops the waiting files and interrupts the running ones. Cancelled files
+ *  are not through, so their hashes must not be remembered.
+ */
+class ImportScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum JobState {
+        JS_WAITING,
+        JS_RUNNING,
+        JS_DONE,        // everything pushed into the queue
+        JS_UNCHANGED,   // same file hash as the last import, nothing parsed
+        JS_FAILED,      // see m_dislikeReason
+        JS_CANCELLED
+    };
+
+    struct ImportJob
+    {
+        QString             m_filename;
+        qint64              m_fileSize;
+        JobState            m_state;
+        int                 m_dislikeReason;    // IcalImportThread::IcalDislikeReasonType
+        // results, valid as soon as the job is through
+        QByteArray          m_fileHash;
+        QVector<QPair<QByteArray, QString>>  m_vEventHashes;
+        QVector<FreeBusyPeriod>  m_freeBusyPeriods;
+        int                 m_numAppointments;
+        int                 m_numSkippedVEvents;
+        IcalImportThread*   m_thread;           // while running
+    };
+
+    explicit ImportScheduler( AppointmentQueue* inQueue, QObject* parent = Q_NULLPTR );
+    // interrupts and waits for the running threads, the queue must not block them
+    ~ImportScheduler();
+
+    // default: number of cores, set before start()
+    void setMaxThreads( const int inMaxThreads );
+    int maxThreads() const;
+
+    /* queues the files and starts the first of them. inStorage knows the hashes of the
+     *  last import, nullptr imports everything. */
+    void start( const QStringList &inFilenames, Storage* inStorage );
+    void cancel();
+    bool isRunning() const;
+
+    // the job id is the index, jobs are sorted largest first
+    const QVector<ImportJob> &jobs() const;
+
+private:
+    void startWaitingJobs();
+
+    AppointmentQueue*   m_queue;
+    Storage*            m_storage;
+    QVector<ImportJob>  m_jobs;
+    int                 m_nextJob;          // first waiting job
+    int                 m_numRunning;
+    int                 m_maxThreads;
+    // free threads of maxThreads(), shared by the import threads and their helpers
+    QSemaphore          m_threadBudget;
+
+signals:
+    // forwarded from the threads, tagged with the job id
+    void sigTickEvent( const int jobId, const int min, const int current, const int max );
+    void sigTickVEvents( const int jobId, const int min, const int current, const int max );
+    // a job is through, its state tells how
+    void sigJobFinished( const int jobId );
+    void sigAllFinished();
+
+private slots:
+    void slotThreadFinished( const int jobId );
+    void slotHelperThreadsDone( const int jobId );
+    void slotWeDislikeIcalFile( const int jobId, const int reason );
+};
+
+#endif // IMPORTSCHEDULER_H
@@ -0,0 +1,62 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "importstoragethread.h"
+#include "storage.h"
+
+
+// number of appointments written within one transaction
+static const int STORAGE_BATCH_SIZE = 64;
+
+
+ImportStorageThread::ImportStorageThread( AppointmentQueue* inQueue, const QString &inDatabaseName,
+                                          QObject* parent )
+    :
+      QThread( parent ),
+      m_queue( inQueue ),
+      m_databaseName( inDatabaseName )
+{
+}
+
+
+void ImportStorageThread::run()
+{
+    // a database connection may only be used within the thread, which created it
+    Storage storage( QString( "import_%1" ).arg( reinterpret_cast<quintptr>(this) ), m_databaseName );
+
+    QVector<Appointment*> batch;
+    batch.reserve( STORAGE_BATCH_SIZE );
+    while( m_queue->popBatch( batch, STORAGE_BATCH_SIZE ) > 0 )
+    {
+        QVector<Appointment*> written;
+        storage.startTransaction();
+        for( Appointment* app : batch )
+        {
+            // @fixme: appointments have an invalid? calendar id.
+            if( storage.upsertAppointment( app ) )
+                written.append( app );
+            else
+                delete app;     // unchanged since last import
+        }
+        storage.commitTransaction();
+
+        if( written.isEmpty() )
+            continue;
+        for( Appointment* app : written )
+            emit sigAppointmentStored( app );
+        emit sigBatchStored( written.count() );
+    }
+}
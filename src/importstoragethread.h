@@ -0,0 +1,56 @@
+/*  This file is part of Daylight.
+    Daylight - Calendarmanager, Appointment-program
+    Copyright (C) 2014-2018  E.Lange
+
+    Daylight is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License.
+
+    Daylight is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef IMPORTSTORAGETHREAD_H
+#define IMPORTSTORAGETHREAD_H
+
+#include <QString>
+#include <QThread>
+
+#include "appointmentmanager.h"
+#include "appointmentqueue.h"
+
+
+/* Last stage of the ical import: takes appointments out of the AppointmentQueue and stores
+ *  them into the database, while the IcalImportThreads are still parsing.
+ * The thread uses its own database connection and writes each batch of appointments
+ *  within one transaction. Appointments unchanged since the last import are dropped.
+ *
+ *  - sigAppointmentStored - an appointment is in the database. The receiver owns the appointment.
+ *  - sigBatchStored - a batch was written, so the visible calendar may need an update.
+ */
+class ImportStorageThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    // inDatabaseName: see Storage::databaseName()
+    explicit ImportStorageThread( AppointmentQueue* inQueue, const QString &inDatabaseName,
+                                  QObject* parent = Q_NULLPTR );
+
+    // stores appointments until the queue is closed and empty
+    void run() override;
+
+private:
+    AppointmentQueue*   m_queue;
+    QString             m_databaseName;
+
+signals:
+    void sigAppointmentStored( Appointment* app );
+    void sigBatchStored( const int numStored );
+};
+
+#endif // IMPORTSTORAGETHREAD_H
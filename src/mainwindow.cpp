@@ -14,11 +14,18 @@
     You should have received a copy of the GNU General Public License
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
+#include <QApplication>
+#include <QCursor>
 #include <QDebug>
+#include <QFile>
 #include <QFileDialog>
+#include <QInputDialog>
+#include <QLocale>
+#include <QMenu>
 #include <QMessageBox>
 
 #include "calendarmanagerdialog.h"
+#include "../icalreader/icalwriter.h"
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
@@ -46,6 +53,18 @@ MainWindow::MainWindow(QWidget* parent) :
     m_ui->mainToolBar->insertWidget(m_ui->actionShowYear, m_toolbarUserCalendarMenu);
     m_ui->mainToolBar->insertSeparator(m_ui->actionShowYear);
 
+    m_toolbarSearch = new QLineEdit();
+    m_toolbarSearch->setPlaceholderText("Search");
+    m_toolbarSearch->setClearButtonEnabled(true);
+    m_toolbarSearch->setMaximumWidth(200);
+    if( not m_storage->haveSearch() )
+    {
+        m_toolbarSearch->setEnabled(false);
+        m_toolbarSearch->setToolTip("Search needs SQLite with FTS5");
+    }
+    m_ui->mainToolBar->addSeparator();
+    m_ui->mainToolBar->addWidget(m_toolbarSearch);
+
     // ATM, there is only one view active at a time.
     m_groupCalendarAppearance = new QActionGroup(this);
     m_groupCalendarAppearance->addAction(m_ui->actionShowYear);
@@ -74,6 +93,14 @@ MainWindow::MainWindow(QWidget* parent) :
     m_userCalendarPool = new UserCalendarPool(this);
     m_storage->loadUserCalendarInfo( m_userCalendarPool );
 
+    // events of last session, needs colors from user calendar pool
+    m_eventCache = nullptr;
+    if( m_settingsManager->useEventCache() )
+    {
+        m_eventCache = new EventCache();
+        loadEventCache();
+    }
+
     // User calendars in Toolbar to switch on/off individual menus
     QMenu* userCalendarMenu = m_userCalendarPool->calendarMenu();
     m_toolbarUserCalendarMenu->setMenu( userCalendarMenu );
@@ -82,13 +109,27 @@ MainWindow::MainWindow(QWidget* parent) :
     m_userCalendarNewDialog = new UserCalendarNew(this);
     m_userCalendarNewDialog->hide();
 
+    // alarms of all years, independent of the event pool
+    m_alarmScheduler = new AlarmScheduler( this );
+    reloadAlarms();
+
     // ical import dialog
-    m_icalImportDialog = new IcalImportDialog( this );
+    m_icalImportDialog = new IcalImportDialog( m_storage, this );
     m_icalImportDialog->hide();
+    m_importRefreshTimer = new QTimer( this );
+    m_importRefreshTimer->setSingleShot( true );
+    m_importRefreshTimer->setInterval( 250 );
+
+    // hidden views get their events later
+    m_dirtyViews = 0;
+    m_dirtyViewTimer = new QTimer( this );
+    m_dirtyViewTimer->setSingleShot( true );
 
     // connect main signals
     connect(m_ui->actionPreferences, SIGNAL(triggered()), this, SLOT(slotSettingsDialog()));
     connect(m_ui->actionOpenICalFile, SIGNAL(triggered()), this, SLOT(slotOpenIcalFile()));
+    connect(m_ui->actionExportICalFile, SIGNAL(triggered()), this, SLOT(slotExportIcalFile()));
+    connect(m_ui->actionFindFreeTime, SIGNAL(triggered()), this, SLOT(slotFindFreeTime()));
     connect(m_ui->actionExit, SIGNAL(triggered()), qApp, SLOT(quit()));
 
     // connect view signals
@@ -113,16 +154,24 @@ MainWindow::MainWindow(QWidget* parent) :
     connect(m_ui->actionAddAppointment, SIGNAL(triggered()), this, SLOT(slotAppointmentDlgStart()));
     connect(m_scene, SIGNAL(signalReconfigureAppointment(QString)), this, SLOT(slotReconfigureAppointment(QString)));
     connect(m_scene, SIGNAL(signalDeleteAppointment(QString)), this, SLOT(slotDeleteAppointment(QString)), Qt::QueuedConnection);
+    connect(m_alarmScheduler, SIGNAL(signalAlarm(QString,QString,DateTime)), this, SLOT(slotAlarm(QString,QString,DateTime)));
+    connect(m_toolbarSearch, SIGNAL(returnPressed()), this, SLOT(slotSearch()));
 
     // user calendars
     connect(m_ui->actionAddUserCalendar, SIGNAL(triggered()), this, SLOT(slotAddUserCalendarDlg()));
-    //connect(m_userCalendarPool, SIGNAL(signalUserCalendarInUseModified()), this, SLOT(slotUserCalendarInUseModified()));
+    connect(m_userCalendarPool, SIGNAL(signalUserCalendarInUseModified()), this, SLOT(slotUserCalendarInUseModified()));
     connect(m_userCalendarNewDialog, SIGNAL(finished(int)), this, SLOT(slotAddUserCalendarDlgFinished(int)));
     connect(m_ui->actionCalendarManager, SIGNAL(triggered()), this, SLOT(slotCalendarManagerDialog()));
 
     // ical import dialog
     connect(m_icalImportDialog, SIGNAL(sigFinishReadingFiles()),
             this, SLOT(slotImportFromFileFinished()) );
+    connect(m_icalImportDialog, SIGNAL(sigAppointmentImported(Appointment*)),
+            this, SLOT(slotImportedAppointment(Appointment*)) );
+    connect(m_icalImportDialog, SIGNAL(sigAppointmentsStored(int)),
+            this, SLOT(slotImportedAppointmentsStored(int)) );
+    connect(m_importRefreshTimer, SIGNAL(timeout()), this, SLOT(slotImportRefresh()));
+    connect(m_dirtyViewTimer, SIGNAL(timeout()), this, SLOT(slotPopulateDirtyView()));
 
     // what to show depends on config
     switch( m_settingsManager->startView() )
@@ -156,22 +205,45 @@ MainWindow::~MainWindow()
     delete m_userCalendarNewDialog;
     delete m_appointmentDialog;
     delete m_navigationDialog;
+    saveEventCache();
     delete m_eventPool;
     delete m_scene;
     delete m_groupCalendarAppearance;
     delete m_toolbarUserCalendarMenu;
     delete m_storage;
     delete m_settingsManager;
+    // events from the cache point into the mapped file, so this goes last
+    delete m_eventCache;
     delete m_ui;
 }
 
 
 void MainWindow::showAppointments(const QDate date)
 {
-    QVector<Appointment*> appointmentsThisYear;
-    if( not m_eventPool->queryMarker( date.year()) )
+    if( m_eventPool->haveCachedYear( date.year() ) )
+    {
+        // show the snapshot now, read the database after the first paint
+        QTimer::singleShot( 0, this, SLOT(slotReplaceCachedEvents()) );
+    }
+    else
+        loadYears( date.year(), date.year() );
+
+    // only the visible view gets its events now, the others when shown or when the user is idle
+    m_dirtyViews = 0xFF;
+    populateView( m_scene->showView() );
+    m_dirtyViewTimer->start( 300 );
+}
+
+
+/* Read the appointments of every year, which is neither marked nor cached. */
+void MainWindow::loadYears(const int firstYear, const int lastYear)
+{
+    for( int year = firstYear; year <= lastYear; year++ )
     {
-        m_storage->loadAppointmentByYear( date.year(), appointmentsThisYear );
+        if( m_eventPool->queryMarker( year ) or m_eventPool->haveCachedYear( year ) )
+            continue;
+        QVector<Appointment*> appointmentsThisYear;
+        m_storage->loadAppointmentByYear( year, appointmentsThisYear );
         for(Appointment* &a :appointmentsThisYear )
         {
             int calId = a->m_userCalendarId;
@@ -179,56 +251,62 @@ void MainWindow::showAppointments(const QDate date)
             a->setEventColor( calColor );
             m_eventPool->addAppointment(a);
         }
-        m_eventPool->addMarker( date.year() );
+        m_eventPool->addMarker( year );
     }
-    //int weekStartDay = m_settingsManager->weekStartDay();
-    QList<UserCalendarInfo*> showHideItems = m_userCalendarPool->calendarInfos();
-    QVector<Event> eventsForYear = m_eventPool->eventsByYear( date.year() );
-    QVector<Event> eventsForMonth= m_eventPool->eventsByYearMonth( date.year(), date.month() );
-    QVector<Event> eventsFor3Weeks = m_eventPool->eventsBy3Weeks( date );
-    QVector<Event> eventsForWeek = m_eventPool->eventsByWeek( date );
-    QVector<Event> eventsForDay = m_eventPool->eventsByDay( date );
+}
+
 
-#if XXX
-    // remove all items from listYear, listMonth, ... for which the calendar is disabled
-    for(const UserCalendarInfo* uci : showHideItems)
+/* Fill the scene items of one view with events around the current date. */
+void MainWindow::populateView(const CalendarShow view)
+{
+    const QDate date = m_scene->date();
+    const QBitArray hidden = m_userCalendarPool->hiddenCalendars();
+    switch( view )
     {
-        if(! uci->m_isVisible)
+        case CalendarShow::SHOW_UNKNOWN:
+            return;
+        case CalendarShow::SHOW_YEAR:
+            m_scene->setEventsForYear( m_eventPool->eventsByYear( date.year(), hidden ) );
+            break;
+        case CalendarShow::SHOW_MONTH:
+            m_scene->setEventsForMonth( m_eventPool->eventsByYearMonth( date.year(), date.month(), hidden ) );
+            break;
+        case CalendarShow::SHOW_3WEEKS:
+            m_scene->setEventsFor3Weeks( m_eventPool->eventsBy3Weeks( date, hidden ) );
+            break;
+        case CalendarShow::SHOW_WEEK:
+            m_scene->setEventsForWeek( m_eventPool->eventsByWeek( date, hidden ) );
+            break;
+        case CalendarShow::SHOW_DAY:
+            m_scene->setEventsForDay( m_eventPool->eventsByDay( date, hidden ) );
+            break;
+    }
+    m_dirtyViews &= ~( 1 << static_cast<int>(view) );
+}
+
+
+void MainWindow::populateViewIfDirty(const CalendarShow view)
+{
+    if( m_dirtyViews & ( 1 << static_cast<int>(view) ) )
+        populateView( view );
+}
+
+
+/* User is idle, fill the next hidden view, which is out of date. */
+void MainWindow::slotPopulateDirtyView()
+{
+    const CalendarShow views[] = { CalendarShow::SHOW_YEAR, CalendarShow::SHOW_MONTH, CalendarShow::SHOW_3WEEKS,
+                                   CalendarShow::SHOW_WEEK, CalendarShow::SHOW_DAY };
+    for( const CalendarShow view : views )
+    {
+        if( m_dirtyViews & ( 1 << static_cast<int>(view) ) )
         {
-            for(Appointment* apm : listYear)
-            {
-                if(apm->m_appointmentData.m_userCalendarId == uci->m_id)
-                    listYear.removeOne(apm);
-            }
-            for(Appointment* apm : listMonth)
-            {
-                if(apm->m_appointmentData.m_userCalendarId == uci->m_id)
-                    listMonth.removeOne(apm);
-            }
-            for(Appointment* apm : list3Weeks)
-            {
-                if(apm->m_appointmentData.m_userCalendarId == uci->m_id)
-                    list3Weeks.removeOne(apm);
-            }
-            for(Appointment* apm : listWeek)
-            {
-                if(apm->m_appointmentData.m_userCalendarId == uci->m_id)
-                    listWeek.removeOne(apm);
-            }
-            for(Appointment* apm : listDay)
-            {
-                if(apm->m_appointmentData.m_userCalendarId == uci->m_id)
-                    listDay.removeOne(apm);
-            }
+            populateView( view );
+            // one view per turn, keep the event loop responsive
+            m_dirtyViewTimer->start( 0 );
+            return;
         }
     }
-#endif
-    // show the rest
-    m_scene->setEventsForYear( eventsForYear );
-    m_scene->setEventsForMonth( eventsForMonth );
-    m_scene->setEventsFor3Weeks( eventsFor3Weeks );
-    m_scene->setEventsForWeek( eventsForWeek );
-    m_scene->setEventsForDay( eventsForDay );
 }
 
 
@@ -253,6 +331,59 @@ void MainWindow::moveEvent(QMoveEvent* event)
 }
 
 
+/* The alarm scheduler has its own copies of the appointments with alarms, as it needs all
+ *  years and not only the ones in the event pool. Read them again after every change. */
+void MainWindow::reloadAlarms()
+{
+    QVector<Appointment*> alarmAppointments;
+    m_storage->loadAppointmentsWithAlarms( alarmAppointments );
+    m_alarmScheduler->setAppointments( alarmAppointments );
+}
+
+
+/* Read the snapshot of recent years, which was written at the end of the last session,
+ *  if the database is unchanged since then. */
+void MainWindow::loadEventCache()
+{
+    QMap<int, QVector<Event>> eventsByYear;
+    if( not m_eventCache->load( m_storage->changeCounter(), eventsByYear ) )
+        return;
+    for( QMap<int, QVector<Event>>::iterator it = eventsByYear.begin(); it != eventsByYear.end(); ++it )
+    {
+        for( Event &e : it.value() )
+            e.m_eventColor = m_userCalendarPool->color( e.m_userCalendarId );
+        m_eventPool->addCachedEvents( it.key(), it.value() );
+    }
+}
+
+/* Write the years around the selected date, as far as they are read from the database.
+ * Streamed events are left out, they are made again on request. */
+void MainWindow::saveEventCache()
+{
+    if( not m_eventCache )
+        return;
+    int currentYear = m_scene->date().year();
+    QMap<int, QVector<Event>> eventsByYear;
+    for( const int year : m_eventPool->markedYears() )
+    {
+        if( qAbs( year - currentYear ) <= 1 )
+            eventsByYear.insert( year, m_eventPool->storedEventsByYear( year ) );
+    }
+    m_eventCache->save( m_storage->changeCounter(), eventsByYear );
+}
+
+
+/* First paint with events from the cache is done, now replace them with appointments
+ *  from the database. */
+void MainWindow::slotReplaceCachedEvents()
+{
+    if( not m_eventPool->haveCachedEvents() )
+        return;
+    m_eventPool->dropCachedEvents();
+    showAppointments( m_scene->date() );
+}
+
+
 void MainWindow::slotOpenIcalFile()
 {
     QFileDialog *dlg = new QFileDialog( this, "open ical file",
@@ -269,21 +400,80 @@ void MainWindow::slotOpenIcalFile()
 }
 
 
+void MainWindow::slotExportIcalFile()
+{
+    QString fileName = QFileDialog::getSaveFileName( this, "export ical file", QString(),
+                                                     "ical-dateien (*.ics)" );
+    if( fileName.isEmpty() )
+        return;
+    QFile file( fileName );
+    if( not file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        QMessageBox::warning( this, "Export", QString( "Cannot write %1" ).arg( fileName ) );
+        return;
+    }
+    QApplication::setOverrideCursor( Qt::WaitCursor );
+    IcalWriter writer( &file );
+    int numAppointments = writer.writeStorage( m_storage );
+    file.close();
+    QApplication::restoreOverrideCursor();
+    if( numAppointments < 0 )
+        QMessageBox::warning( this, "Export", QString( "Cannot write %1" ).arg( fileName ) );
+}
+
+
+/* Import pipeline is through, all appointments are stored and forwarded
+ *  to slotImportedAppointment(). */
 void MainWindow::slotImportFromFileFinished()
 {
     //m_icalImportDialog->hide();
+    m_importRefreshTimer->stop();
+    showAppointments( m_scene->date() );
+    reloadAlarms();
+    // delete threads
+    m_icalImportDialog->deleteThreadsAndData();
+}
 
-    // generated data is in the buffer of thread
-    for( const ThreadInfo ti : m_icalImportDialog->m_threads )
+
+/* The import pipeline has stored an appointment and we own it now.
+ * If it touches a year, which is already in the event pool, it goes to the pool,
+ *  otherwise storage delivers it, when its year is requested. */
+void MainWindow::slotImportedAppointment( Appointment* app )
+{
+    bool inPool = m_eventPool->haveAppointment( app->m_uid );
+    if( inPool )
+        m_eventPool->removeAppointmentWithEventsById( app->m_uid );
+    bool yearInPool = false;
+    // same year range, as Storage::loadAppointmentByYear() uses
+    for( int year = app->m_minYear; year <= app->m_maxYear; year++ )
     {
-        for( const Appointment* app : ti.thread->m_appointments )
+        if( m_eventPool->queryMarker( year ) )
         {
-            // @fixme: appointments have an invalid? calendar id.
-            m_storage->updateAppointment( app );
+            yearInPool = true;
+            break;
         }
     }
-    // delete threads
-    m_icalImportDialog->deleteThreadsAndData();
+    if( (inPool or yearInPool) and ( not app->m_eventVector.isEmpty() or app->isStreamed() ) )
+    {
+        app->setEventColor( m_userCalendarPool->color( app->m_userCalendarId ) );
+        m_eventPool->addAppointment( app );
+    }
+    else
+        delete app;
+}
+
+
+/* A batch of imported appointments is in the pool, update the scene soon. */
+void MainWindow::slotImportedAppointmentsStored( const int /*numStored*/ )
+{
+    if( not m_importRefreshTimer->isActive() )
+        m_importRefreshTimer->start();
+}
+
+
+void MainWindow::slotImportRefresh()
+{
+    showAppointments( m_scene->date() );
 }
 
 
@@ -450,6 +640,7 @@ void MainWindow::slotSetNextDate()
 void MainWindow::slotShowYear()
 {
     m_scene->slotShowYear();
+    populateViewIfDirty(CalendarShow::SHOW_YEAR);
     m_toolbarDateLabel->setText(m_scene->date().toString("yyyy"));
     m_settingsManager->setSelectedView(SettingStartWithView::START_YEAR);
 }
@@ -458,6 +649,7 @@ void MainWindow::slotShowYear()
 void MainWindow::slotShowMonth()
 {
     m_scene->slotShowMonth();
+    populateViewIfDirty(CalendarShow::SHOW_MONTH);
     m_toolbarDateLabel->setText(m_scene->date().toString("MMMM yyyy"));
     m_settingsManager->setSelectedView(SettingStartWithView::START_MONTH);
 }
@@ -466,6 +658,7 @@ void MainWindow::slotShowMonth()
 void MainWindow::slotShow3Weeks()
 {
     m_scene->slotShow3Weeks();
+    populateViewIfDirty(CalendarShow::SHOW_3WEEKS);
     QDate start(m_scene->date());
     start = start.addDays( m_settingsManager->weekStartDay() - start.dayOfWeek() ).addDays(-7);
     QDate end = start.addDays(20);
@@ -478,6 +671,7 @@ void MainWindow::slotShow3Weeks()
 void MainWindow::slotShowWeek()
 {
     m_scene->slotShowWeek();
+    populateViewIfDirty(CalendarShow::SHOW_WEEK);
     QDate start(m_scene->date());
     start = start.addDays( m_settingsManager->weekStartDay() - start.dayOfWeek() );
     QDate end = start.addDays(6);
@@ -490,6 +684,7 @@ void MainWindow::slotShowWeek()
 void MainWindow::slotShowDay()
 {
     m_scene->slotShowDay();
+    populateViewIfDirty(CalendarShow::SHOW_DAY);
     m_toolbarDateLabel->setText(m_scene->date().toString("dd.MM.yyyy"));
     m_settingsManager->setSelectedView(SettingStartWithView::START_DAY);
 }
@@ -548,6 +743,14 @@ void MainWindow::slotCalendarManagerDialog()
 }
 
 
+/* User switched a calendar on or off in the toolbar menu. Events are in the pool,
+ *  the views just need a new query. */
+void MainWindow::slotUserCalendarInUseModified()
+{
+    showAppointments( m_scene->date() );
+}
+
+
 /* User changes title and color, but not visibility.
  * connected in MainWindow::slotCalendarManagerDialog() */
 void MainWindow::slotModifyCalendar(const int calendarId, const QString & title, const QColor & color)
@@ -568,8 +771,10 @@ void MainWindow::slotModifyCalendar(const int calendarId, const QString & title,
 void MainWindow::slotDeleteCalendar(const int calendarId)
 {
     m_userCalendarPool->removeUserCalendar(calendarId);
+    m_eventPool->removeAppointmentsByCalendarId(calendarId);
     m_storage->removeUserCalendar(calendarId);
     showAppointments(m_scene->date());
+    reloadAlarms();
 }
 
 
@@ -665,6 +870,7 @@ void MainWindow::slotAppointmentDlgFinished(int returncode)
 
     m_appointmentDialog->showHideProgressBar( true );
     showAppointments(m_scene->date());
+    reloadAlarms();
     m_appointmentDialog->hide();
 }
 
@@ -685,4 +891,105 @@ void MainWindow::slotDeleteAppointment( QString appointmentId )
     m_eventPool->removeAppointmentWithEventsById( appointmentId );
     m_storage->removeAppointment( appointmentId );
     showAppointments(m_scene->date());
+    reloadAlarms();
+}
+
+
+/* User pressed return in the search field. The hits show up in a menu below it,
+ *  sorted by relevance. */
+void MainWindow::slotSearch()
+{
+    QVector<SearchHit> hits;
+    m_storage->searchAppointments( m_toolbarSearch->text(), 50, hits );
+
+    QMenu* hitMenu = new QMenu( this );
+    hitMenu->setAttribute( Qt::WA_DeleteOnClose );
+    if( hits.isEmpty() )
+        hitMenu->addAction( "nothing found" )->setEnabled( false );
+    for( const SearchHit &hit : hits )
+    {
+        QAction* hitAction = hitMenu->addAction( QString( "%1   %2" )
+                                                 .arg( QLocale().toString( hit.m_date, QLocale::ShortFormat ) )
+                                                 .arg( hit.m_summary ) );
+        hitAction->setData( hit.m_date );
+    }
+    connect( hitMenu, SIGNAL(triggered(QAction*)), this, SLOT(slotSearchHitSelected(QAction*)) );
+    hitMenu->popup( m_toolbarSearch->mapToGlobal( QPoint( 0, m_toolbarSearch->height() ) ) );
+}
+
+
+/* jump to the occurrence of the hit */
+void MainWindow::slotSearchHitSelected( QAction* action )
+{
+    QDate date = action->data().toDate();
+    if( date.isValid() )
+        slotSetDate( date );
+}
+
+
+/* Free times of the visible calendars in the 3 weeks from the current date on. They show
+ *  up in a menu like search hits, selecting one jumps to its day. */
+void MainWindow::slotFindFreeTime()
+{
+    bool ok = false;
+    const int minMinutes = QInputDialog::getInt( this, "Find Free Time", "minimum length in minutes:",
+                                                 60, 5, 24 * 60, 15, &ok );
+    if( not ok )
+        return;
+
+    // cached years have no appointments, free/busy needs the database
+    slotReplaceCachedEvents();
+    const QDate first = m_scene->date();
+    const QDate last = first.addDays( 20 );
+    loadYears( first.year(), last.year() );
+    QVector<FreeBusyPeriod> publishedBusy;
+    m_storage->loadFreeBusyPeriods( QDateTime( first, QTime( 0, 0 ) ).toSecsSinceEpoch(),
+                                    QDateTime( last.addDays( 1 ), QTime( 0, 0 ) ).toSecsSinceEpoch(),
+                                    publishedBusy );
+    const QVector<FreeBusyInterval> freeTimes =
+            m_eventPool->freeSlots( first, last, m_userCalendarPool->visibleCalendars(),
+                                    publishedBusy, minMinutes * 60 );
+
+    QMenu* freeMenu = new QMenu( this );
+    freeMenu->setAttribute( Qt::WA_DeleteOnClose );
+    if( freeTimes.isEmpty() )
+        freeMenu->addAction( "no free time" )->setEnabled( false );
+    for( const FreeBusyInterval &freeTime : freeTimes.mid( 0, 50 ) )
+    {
+        const QDateTime start = QDateTime::fromSecsSinceEpoch( freeTime.m_startSecs );
+        const QDateTime end = QDateTime::fromSecsSinceEpoch( freeTime.m_endSecs );
+        QAction* freeAction = freeMenu->addAction( QString( "%1 - %2" )
+                                                   .arg( QLocale().toString( start, QLocale::ShortFormat ) )
+                                                   .arg( QLocale().toString( end, QLocale::ShortFormat ) ) );
+        freeAction->setData( start.date() );
+    }
+    connect( freeMenu, SIGNAL(triggered(QAction*)), this, SLOT(slotFreeTimeSelected(QAction*)) );
+    freeMenu->popup( QCursor::pos() );
+}
+
+
+/* jump to the day of the free time */
+void MainWindow::slotFreeTimeSelected( QAction* action )
+{
+    QDate date = action->data().toDate();
+    if( date.isValid() )
+        slotSetDate( date );
+}
+
+
+/* An alarm is due. Show it without blocking the main window. */
+void MainWindow::slotAlarm( const QString /*uid*/, const QString summary, const DateTime eventStart )
+{
+    QString when;
+    if( eventStart.isDate() )
+        when = QLocale().toString( eventStart.date(), QLocale::ShortFormat );
+    else
+        when = QLocale().toString( eventStart.toLocalTime(), QLocale::ShortFormat );
+    QMessageBox* alarmMsgBox = new QMessageBox( QMessageBox::Information,
+                                                "Alarm",
+                                                QString( "%1\n%2" ).arg( summary ).arg( when ),
+                                                QMessageBox::Ok, this );
+    alarmMsgBox->setAttribute( Qt::WA_DeleteOnClose );
+    alarmMsgBox->setModal( false );
+    alarmMsgBox->show();
 }
@@ -17,12 +17,16 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QLineEdit>
 #include <QMainWindow>
+#include <QTimer>
 #include <QToolButton>
 
+#include "alarmscheduler.h"
 #include "appointmentdialog.h"
 #include "appointmentmanager.h"
 #include "calendarscene.h"
+#include "eventcache.h"
 #include "eventpool.h"
 #include "icalimportdialog.h"
 #include "navigationdialog.h"
@@ -63,11 +67,13 @@ private:
     QActionGroup*       m_groupCalendarAppearance;  // Year, Month, ...
     QToolButton*        m_toolbarDateLabel;     // label/button to show current selected date and start navigationDialog
     QToolButton*        m_toolbarUserCalendarMenu;  // shows user calendars, switch them on/off
+    QLineEdit*          m_toolbarSearch;        // full-text search, hits show up in a menu
     CalendarScene*      m_scene;                // where we paint calendar in
 
     // Part Storage:
     Storage*            m_storage;              // database of appointments, storage on disk
     EventPool*          m_eventPool;            // database of events during runtime
+    EventCache*         m_eventCache;           // snapshot of m_eventPool for a fast start, may be nullptr
     UserCalendarPool*   m_userCalendarPool;     // Container for user calendars
 
     // Part Dialogues:
@@ -77,7 +83,23 @@ private:
     SettingsManager*    m_settingsManager;
     UserCalendarNew*    m_userCalendarNewDialog;    // Dialog to add a user calendar
 
+    // Part Alarms:
+    AlarmScheduler*     m_alarmScheduler;       // fires alarms, has its own copies of appointments with alarms
+
+    // Part Import:
+    QTimer*             m_importRefreshTimer;   // collects stored batches to one scene update
+
+    // Part Views:
+    quint8              m_dirtyViews;           // bit per CalendarShow, view needs new events
+    QTimer*             m_dirtyViewTimer;       // fills hidden dirty views, when the user is idle
+
     void showAppointments(const QDate date);   // update appointments
+    void loadYears(const int firstYear, const int lastYear);   // appointments of years not in the pool yet
+    void populateView(const CalendarShow view);
+    void populateViewIfDirty(const CalendarShow view);
+    void loadEventCache();
+    void saveEventCache();
+    void reloadAlarms();
 
 protected:
     void resizeEvent(QResizeEvent*);
@@ -86,7 +108,13 @@ protected:
 public slots:
     // file
     void slotOpenIcalFile();
+    void slotExportIcalFile();
     void slotImportFromFileFinished();
+    void slotImportedAppointment( Appointment* app );
+    void slotImportedAppointmentsStored( const int numStored );
+    void slotImportRefresh();
+    void slotReplaceCachedEvents();
+    void slotPopulateDirtyView();
 
     // set date
     void slotShowHideNavigationDlg();
@@ -110,6 +138,7 @@ public slots:
     void slotAddUserCalendarDlg();
     void slotAddUserCalendarDlgFinished(int returncode);
     void slotCalendarManagerDialog();
+    void slotUserCalendarInUseModified();
     void slotModifyCalendar(const int calendarId, const QString & title, const QColor & color);
     void slotDeleteCalendar(const int calendarId);
 
@@ -118,6 +147,15 @@ public slots:
     void slotReconfigureAppointment(QString appointmentId); // user clicks on an appointment, configure AppointmentDlg and start
     void slotAppointmentDlgFinished(int returncode);
     void slotDeleteAppointment( QString appointmentId );
+    void slotAlarm( const QString uid, const QString summary, const DateTime eventStart );
+
+    // search
+    void slotSearch();
+    void slotSearchHitSelected( QAction* action );
+
+    // free/busy
+    void slotFindFreeTime();
+    void slotFreeTimeSelected( QAction* action );
 };
 
 
@@ -124,6 +124,8 @@ void SettingsManager::defaultSettings()
     m_settings.m_startView = SettingStartWithView::START_YEAR;
     m_settings.m_startWithToday = true;
     m_settings.m_warnMeOnAppointmentDelete = false;
+    m_settings.m_useEventCache = true;
+    m_settings.m_useDayRasterCache = false;
     // day
     m_settings.m_dayStartHour = 8;
     m_settings.m_dayEndHour = 20;
@@ -145,6 +147,8 @@ void SettingsManager::settingsToGroups()
     setValue("StartView", m_settings.m_startView);
     setValue("StartWithToday", m_settings.m_startWithToday);
     setValue("WarnOnAppointmentDelete", m_settings.m_warnMeOnAppointmentDelete);
+    setValue("UseEventCache", m_settings.m_useEventCache);
+    setValue("UseDayRasterCache", m_settings.m_useDayRasterCache);
     endGroup();
     beginGroup("DAYS");
     setValue("DayStartHour", m_settings.m_dayStartHour);
@@ -177,6 +181,8 @@ void SettingsManager::groupsToSettings()
     m_settings.m_startView = SettingStartWithView( value("StartView", m_settings.m_startView).toInt(&ok));
     m_settings.m_startWithToday= value("StartWithToday", m_settings.m_startWithToday).toBool();
     m_settings.m_warnMeOnAppointmentDelete = value("WarnOnAppointmentDelete", m_settings.m_warnMeOnAppointmentDelete).toBool();
+    m_settings.m_useEventCache = value("UseEventCache", m_settings.m_useEventCache).toBool();
+    m_settings.m_useDayRasterCache = value("UseDayRasterCache", m_settings.m_useDayRasterCache).toBool();
     endGroup();
     beginGroup("DAYS");
     m_settings.m_dayStartHour = value("DayStartHour", m_settings.m_dayStartHour).toInt(&ok);
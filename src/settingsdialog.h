@@ -42,6 +42,8 @@ struct SettingsData
     SettingStartWithView m_startView;   // start with this view on next program start
     bool m_startWithToday;              // true: start with today, false: start with last selected date
     bool m_warnMeOnAppointmentDelete;   // true: show a dialog on appointment delete
+    bool m_useEventCache;               // true: keep a snapshot of recent events on disk for a fast start
+    bool m_useDayRasterCache;           // true: year and month days keep their painting as pixmap
     // day time
     int m_dayStartHour;                 // 0...20
     int m_dayEndHour;                   // m_dayStartHour + 1 ... 24
@@ -76,6 +78,8 @@ public:
     int weekStartDay() const { return m_settings.m_weekStartDay; }
     int week3AddDays() const { return 7 * m_settings.m_3weeks_add_value; }
     bool warnOnAppointmentDelete() const { return m_settings.m_warnMeOnAppointmentDelete; }
+    bool useEventCache() const { return m_settings.m_useEventCache; }
+    bool useDayRasterCache() const { return m_settings.m_useDayRasterCache; }
 
 private:
     void defaultSettings();
@@ -17,21 +17,55 @@
 #include <QDebug>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QSqlRecord>
+#include <QStringList>
 
 #include "datetime.h"
 #include "storage.h"
 
 
-Storage::Storage()
+Storage::Storage( const QString & inConnectionName, const QString & inDatabaseName )
+    :
+      m_inTransaction( false ),
+      m_haveSearch( false )
 {
-    createDatabase();
+    createDatabase( inConnectionName, inDatabaseName );
 }
 
 
-void Storage::createDatabase()
+Storage::~Storage()
 {
-    m_db = QSqlDatabase::addDatabase("QSQLITE");
-    m_db.setDatabaseName("daylightdb.sqlite3");
+    if( m_inTransaction )
+        commitTransaction();
+    m_qUpsertSelect.finish();
+    m_qUpsertSelect = QSqlQuery();
+    QString connectionName = m_db.connectionName();
+    m_db.close();
+    m_db = QSqlDatabase();
+    if( connectionName != QSqlDatabase::defaultConnection )
+        QSqlDatabase::removeDatabase( connectionName );
+}
+
+
+QString Storage::databaseName() const
+{
+    return m_db.databaseName();
+}
+
+
+bool Storage::haveSearch() const
+{
+    return m_haveSearch;
+}
+
+
+void Storage::createDatabase( const QString & inConnectionName, const QString & inDatabaseName )
+{
+    if( inConnectionName.isEmpty() )
+        m_db = QSqlDatabase::addDatabase("QSQLITE");
+    else
+        m_db = QSqlDatabase::addDatabase("QSQLITE", inConnectionName);
+    m_db.setDatabaseName( inDatabaseName );
     if( not m_db.open() )
         qDebug() << "ERR: Cannot open Database.";
 
@@ -66,15 +100,48 @@ void Storage::createDatabase()
         qDebug() << "ERROR: Storage::createDatabase(): Cannot determine number of usercalendars with default id";
 
 
+    /* databases from older versions have basics without id. The search index refers to
+     *  the implicit rowid, which VACUUM may renumber, so copy them into a new table. */
+    bool migrateBasics = m_db.tables().contains( "basics" ) and not m_db.record( "basics" ).contains( "id" );
+    if( migrateBasics )
+    {
+        const QStringList oldSearch = { "DROP TRIGGER IF EXISTS basics_search_insert",
+                                        "DROP TRIGGER IF EXISTS basics_search_delete",
+                                        "DROP TRIGGER IF EXISTS basics_search_update",
+                                        "DROP TABLE IF EXISTS search" };
+        for( const QString & statement : oldSearch )
+            m_db.exec( statement );
+        query = m_db.exec( "ALTER TABLE basics RENAME TO basics_old" );
+        err = query.lastError();
+        if( err.type() != QSqlError::NoError )
+            qDebug() << " ERROR: Storage::createDatabase(): ALTER TABLE basics : " << err.text();
+    }
+
+    // id is the rowid of the search index, see below
     query = m_db.exec
             ("CREATE TABLE IF NOT EXISTS basics"
              "(uid VARCHAR, sequence INT, "
              "start DATETIME, start_tz VARCHAR, end DATETIME, end_tz VARCHAR,"
-             "summary VARCHAR, description VARCHAR, busyfree INT)");
+             "summary VARCHAR, description VARCHAR, busyfree INT, id INTEGER PRIMARY KEY)");
     err = query.lastError();
     if( err.type() != QSqlError::NoError )
         qDebug() << " ERROR: Storage::createDatabase(): CREATE TABLE basics : " << err.text();
 
+    if( migrateBasics )
+    {
+        // copy the columns both tables have, very old ones lack busyfree
+        QSqlRecord oldBasics = m_db.record( "basics_old" );
+        QStringList columns;
+        for( int i = 0; i < oldBasics.count(); i++ )
+            columns.append( oldBasics.fieldName( i ) );
+        query = m_db.exec( QString( "INSERT INTO basics(%1) SELECT %1 FROM basics_old" ).arg( columns.join( ", " ) ) );
+        err = query.lastError();
+        if( err.type() != QSqlError::NoError )
+            qDebug() << " ERROR: Storage::createDatabase(): copy basics : " << err.text();
+        else
+            m_db.exec( "DROP TABLE basics_old" );
+    }
+
     query = m_db.exec
             ("CREATE TABLE IF NOT EXISTS alarms"
              "(uid VARCHAR, rel_timeout BIGINT, "
@@ -110,17 +177,151 @@ void Storage::createDatabase()
             ("CREATE TABLE IF NOT EXISTS appointments"
              "(uid VARCHAR, min_year INT, max_year INT, allyears VARCHAR, "
              "usercalendar_id INT,"
-             "have_recurrence BOOL, have_alarms BOOL)");
+             "have_recurrence BOOL, have_alarms BOOL, content_hash VARCHAR)");
     err = query.lastError();
     if( err.type() != QSqlError::NoError )
         qDebug() << " ERROR: Storage::createDatabase(): CREATE TABLE appointments : " << err.text();
+
+    query = m_db.exec
+            ("CREATE TABLE IF NOT EXISTS importfiles"
+             "(filename VARCHAR, hash VARCHAR)");
+    err = query.lastError();
+    if( err.type() != QSqlError::NoError )
+        qDebug() << " ERROR: Storage::createDatabase(): CREATE TABLE importfiles : " << err.text();
+
+    query = m_db.exec
+            ("CREATE TABLE IF NOT EXISTS importvevents"
+             "(filename VARCHAR, hash VARCHAR, uid VARCHAR)");
+    err = query.lastError();
+    if( err.type() != QSqlError::NoError )
+        qDebug() << " ERROR: Storage::createDatabase(): CREATE TABLE importvevents : " << err.text();
+
+    query = m_db.exec
+            ("CREATE TABLE IF NOT EXISTS freebusy"
+             "(filename VARCHAR, usercalendar_id INT, start_secs BIGINT, end_secs BIGINT)");
+    err = query.lastError();
+    if( err.type() != QSqlError::NoError )
+        qDebug() << " ERROR: Storage::createDatabase(): CREATE TABLE freebusy : " << err.text();
+
+    // databases from older versions lack the content hash
+    if( not m_db.record( "appointments" ).contains( "content_hash" ) )
+    {
+        query = m_db.exec( "ALTER TABLE appointments ADD COLUMN content_hash VARCHAR" );
+        err = query.lastError();
+        if( err.type() != QSqlError::NoError )
+            qDebug() << " ERROR: Storage::createDatabase(): ALTER TABLE appointments : " << err.text();
+    }
+
+    query = m_db.exec( "CREATE INDEX IF NOT EXISTS appointments_uid ON appointments(uid)" );
+    err = query.lastError();
+    if( err.type() != QSqlError::NoError )
+        qDebug() << " ERROR: Storage::createDatabase(): CREATE INDEX appointments_uid : " << err.text();
+
+    // next occurrence of a search hit, see searchAppointments()
+    query = m_db.exec( "CREATE INDEX IF NOT EXISTS events_uid_start ON events(uid, start)" );
+    err = query.lastError();
+    if( err.type() != QSqlError::NoError )
+        qDebug() << " ERROR: Storage::createDatabase(): CREATE INDEX events_uid_start : " << err.text();
+
+    /* full-text index over summary and description. The rowid is basics.id, triggers
+     *  keep it up to date with every store, update, removal and import. Without FTS5
+     *  in the SQLite library there is no search at all. */
+    bool haveSearchTable = m_db.tables().contains( "search" );
+    query = m_db.exec( "CREATE VIRTUAL TABLE IF NOT EXISTS search "
+                       "USING fts5(uid UNINDEXED, summary, description)" );
+    err = query.lastError();
+    m_haveSearch = err.type() == QSqlError::NoError;
+    if( not m_haveSearch )
+        qDebug() << " ERROR: Storage::createDatabase(): CREATE VIRTUAL TABLE search : " << err.text();
+    else
+    {
+        const QStringList searchTriggers = {
+            "CREATE TRIGGER IF NOT EXISTS basics_search_insert AFTER INSERT ON basics BEGIN "
+            "INSERT INTO search(rowid, uid, summary, description) "
+            "VALUES(new.id, new.uid, new.summary, new.description); END",
+            "CREATE TRIGGER IF NOT EXISTS basics_search_delete AFTER DELETE ON basics BEGIN "
+            "DELETE FROM search WHERE rowid=old.id; END",
+            "CREATE TRIGGER IF NOT EXISTS basics_search_update AFTER UPDATE ON basics BEGIN "
+            "DELETE FROM search WHERE rowid=old.id; "
+            "INSERT INTO search(rowid, uid, summary, description) "
+            "VALUES(new.id, new.uid, new.summary, new.description); END" };
+        for( const QString & trigger : searchTriggers )
+        {
+            query = m_db.exec( trigger );
+            err = query.lastError();
+            if( err.type() != QSqlError::NoError )
+                qDebug() << " ERROR: Storage::createDatabase(): CREATE TRIGGER search : " << err.text();
+        }
+        // databases from older versions have appointments, but no index
+        if( not haveSearchTable )
+            m_db.exec( "INSERT INTO search(rowid, uid, summary, description) "
+                       "SELECT id, uid, summary, description FROM basics" );
+    }
+
+    /* change counter: every write to appointments increases it. Caches of database
+     *  content (like EventCache) compare it to see, if they are still valid. */
+    query = m_db.exec( "CREATE TABLE IF NOT EXISTS changecounter(value BIGINT)" );
+    err = query.lastError();
+    if( err.type() != QSqlError::NoError )
+        qDebug() << " ERROR: Storage::createDatabase(): CREATE TABLE changecounter : " << err.text();
+    QSqlQuery test_counter = m_db.exec( "SELECT count(value) FROM changecounter" );
+    if( test_counter.first() and test_counter.value(0).toInt() < 1 )
+        m_db.exec( "INSERT INTO changecounter VALUES(0)" );
+    const QStringList counterTriggers = { "INSERT", "UPDATE", "DELETE" };
+    for( const QString & trigger : counterTriggers )
+    {
+        query = m_db.exec( QString( "CREATE TRIGGER IF NOT EXISTS appointments_count_%1 "
+                                    "AFTER %2 ON appointments "
+                                    "BEGIN UPDATE changecounter SET value = value + 1; END" )
+                           .arg( trigger.toLower() ).arg( trigger ) );
+        err = query.lastError();
+        if( err.type() != QSqlError::NoError )
+            qDebug() << " ERROR: Storage::createDatabase(): CREATE TRIGGER " << trigger << " : " << err.text();
+    }
+
+    m_qUpsertSelect = QSqlQuery( m_db );
+    if( not m_qUpsertSelect.prepare( "SELECT appointments.content_hash, basics.sequence "
+                                     "FROM appointments LEFT JOIN basics ON appointments.uid=basics.uid "
+                                     "WHERE appointments.uid=:uid" ) )
+        qDebug() << " ERROR: Storage::createDatabase(): prepare upsert : " << m_qUpsertSelect.lastError().text();
+}
+
+
+qint64 Storage::changeCounter()
+{
+    QSqlQuery qCounter = m_db.exec( "SELECT value FROM changecounter" );
+    if( qCounter.first() )
+        return qCounter.value(0).toLongLong();
+    qDebug() << "ERR: Storage::changeCounter(), " << qCounter.lastError().text();
+    return -1;
+}
+
+
+bool Storage::startTransaction()
+{
+    if( m_inTransaction )
+        return false;
+    m_inTransaction = m_db.transaction();
+    if( not m_inTransaction )
+        qDebug() << "ERR: Storage::startTransaction(), " << m_db.lastError().text();
+    return m_inTransaction;
+}
+
+
+void Storage::commitTransaction()
+{
+    if( not m_inTransaction )
+        return;
+    if( not m_db.commit() )
+        qDebug() << "ERR: Storage::commitTransaction(), " << m_db.lastError().text();
+    m_inTransaction = false;
 }
 
 
 void Storage::storeAppointment(const Appointment* apmData )
 {
     QSqlQuery iApm(m_db);
-    iApm.prepare("INSERT INTO appointments VALUES(:uid, :minyear, :maxyear, :allyears, :calid, :haverec, :havealarm)");
+    iApm.prepare("INSERT INTO appointments VALUES(:uid, :minyear, :maxyear, :allyears, :calid, :haverec, :havealarm, :hash)");
     iApm.bindValue(":uid", apmData->m_uid);
     iApm.bindValue(":minyear", apmData->m_minYear);
     iApm.bindValue(":maxyear", apmData->m_maxYear);
@@ -130,10 +331,12 @@ void Storage::storeAppointment(const Appointment* apmData )
     iApm.bindValue(":calid", apmData->m_userCalendarId );
     iApm.bindValue(":haverec", apmData->m_haveRecurrence );
     iApm.bindValue(":havealarm", apmData->m_haveAlarm );
+    iApm.bindValue(":hash", QString::fromLatin1( apmData->contentHash() ) );
     iApm.exec();
 
     QSqlQuery iBas(m_db);
-    iBas.prepare("INSERT INTO basics VALUES(:uid, :sequence, :start, :starttz, :end, :endtz, :summary, :description, :busyfree)");
+    iBas.prepare("INSERT INTO basics(uid, sequence, start, start_tz, end, end_tz, summary, description, busyfree) "
+                 "VALUES(:uid, :sequence, :start, :starttz, :end, :endtz, :summary, :description, :busyfree)");
     iBas.bindValue(":uid", apmData->m_uid);
     iBas.bindValue(":sequence", apmData->m_appBasics->m_sequence);
     QString dtString;
@@ -203,11 +406,12 @@ void Storage::storeAppointment(const Appointment* apmData )
         iRec.exec();
     }
 
-    m_db.transaction();
+    // within startTransaction() this fails and we just run inside the outer transaction
+    bool haveTransaction = m_db.transaction();
     QSqlQuery iEve(m_db);
     int countAppointments = apmData->m_eventVector.count() - 1;
     int currentCount = 0;
-    for( const Event e : apmData->m_eventVector )
+    for( const Event &e : apmData->m_eventVector )
     {
         iEve.prepare("INSERT INTO events VALUES(:uid, :text, :start, :end, :timezone, :is_alarm)");
         iEve.bindValue(":uid", apmData->m_uid);
@@ -221,7 +425,8 @@ void Storage::storeAppointment(const Appointment* apmData )
         iEve.exec();
         emit sigStoreEvent(0, currentCount++, countAppointments );
     }
-    m_db.commit();
+    if( haveTransaction )
+        m_db.commit();
 }
 
 
@@ -235,16 +440,238 @@ void Storage::updateAppointment( const Appointment* apmData )
 }
 
 
-void Storage::loadAppointmentByYear(const int year, QVector<Appointment*>& outAppointments )
+bool Storage::upsertAppointment( const Appointment* apmData )
 {
-    outAppointments.clear();
+    if( apmData->m_uid.isEmpty() )
+        return false;
+
+    m_qUpsertSelect.bindValue( ":uid", apmData->m_uid );
+    if( not m_qUpsertSelect.exec() )
+    {
+        qDebug() << "ERR: Storage::upsertAppointment(), select, " << m_qUpsertSelect.lastError().text();
+        updateAppointment( apmData );
+        return true;
+    }
+
+    bool haveStored = m_qUpsertSelect.first();
+    if( haveStored )
+    {
+        bool ok;
+        QString storedHash = m_qUpsertSelect.value(0).toString();
+        int storedSequence = m_qUpsertSelect.value(1).toInt( &ok );
+        m_qUpsertSelect.finish();
+        // RFC 5545: a higher SEQUENCE is the newer revision
+        if( ok and apmData->m_appBasics and storedSequence > apmData->m_appBasics->m_sequence )
+            return false;
+        if( storedHash == QString::fromLatin1( apmData->contentHash() ) )
+            return false;
+        removeAppointment( apmData->m_uid );
+    }
+    else
+        m_qUpsertSelect.finish();
+
+    storeAppointment( apmData );
+    return true;
+}
+
+
+QByteArray Storage::importFileHash( const QString inFilename )
+{
+    // a file is only unchanged, if none of its appointments got deleted meanwhile
+    QSqlQuery qFile(m_db);
+    qFile.prepare("SELECT hash FROM importfiles WHERE filename=:fn AND NOT EXISTS "
+                  "(SELECT 1 FROM importvevents WHERE importvevents.filename=:fn2 AND "
+                  "importvevents.uid NOT IN (SELECT uid FROM appointments))");
+    qFile.bindValue(":fn", inFilename);
+    qFile.bindValue(":fn2", inFilename);
+    if( not qFile.exec() )
+    {
+        qDebug() << "ERR: Storage::importFileHash(), " << qFile.lastError().text();
+        return QByteArray();
+    }
+    if( qFile.first() )
+        return qFile.value(0).toString().toLatin1();
+    return QByteArray();
+}
+
+
+QSet<QByteArray> Storage::importVEventHashes( const QString inFilename )
+{
+    QSet<QByteArray> hashes;
+    QSqlQuery qVEvents(m_db);
+    qVEvents.prepare("SELECT importvevents.hash FROM importvevents "
+                     "JOIN appointments ON importvevents.uid=appointments.uid "
+                     "WHERE importvevents.filename=:fn");
+    qVEvents.bindValue(":fn", inFilename);
+    if( not qVEvents.exec() )
+    {
+        qDebug() << "ERR: Storage::importVEventHashes(), " << qVEvents.lastError().text();
+        return hashes;
+    }
+    while( qVEvents.next() )
+        hashes.insert( qVEvents.value(0).toString().toLatin1() );
+    return hashes;
+}
+
+
+void Storage::setImportHashes( const QString inFilename, const QByteArray inFileHash,
+                               const QVector<QPair<QByteArray, QString>> &inVEventHashes )
+{
+    QSqlQuery dFile(m_db);
+    dFile.prepare("DELETE FROM importfiles WHERE filename=:fn");
+    dFile.bindValue(":fn", inFilename);
+    QSqlQuery dVEvents(m_db);
+    dVEvents.prepare("DELETE FROM importvevents WHERE filename=:fn");
+    dVEvents.bindValue(":fn", inFilename);
+    QSqlQuery iFile(m_db);
+    iFile.prepare("INSERT INTO importfiles VALUES(:fn, :hash)");
+    iFile.bindValue(":fn", inFilename);
+    iFile.bindValue(":hash", QString::fromLatin1( inFileHash ) );
+    QSqlQuery iVEvent(m_db);
+    iVEvent.prepare("INSERT INTO importvevents VALUES(:fn, :hash, :uid)");
+
+    bool haveTransaction = m_db.transaction();
+    dFile.exec();
+    dVEvents.exec();
+    iFile.exec();
+    for( const QPair<QByteArray, QString> &vevent : inVEventHashes )
+    {
+        iVEvent.bindValue(":fn", inFilename);
+        iVEvent.bindValue(":hash", QString::fromLatin1( vevent.first ) );
+        iVEvent.bindValue(":uid", vevent.second );
+        if( not iVEvent.exec() )
+            qDebug() << "ERR: Storage::setImportHashes(), " << iVEvent.lastError().text();
+    }
+    if( haveTransaction )
+        m_db.commit();
+}
+
+
+void Storage::setFreeBusyPeriods( const QString inFilename, const QVector<FreeBusyPeriod> &inPeriods )
+{
+    QSqlQuery dPeriods(m_db);
+    dPeriods.prepare("DELETE FROM freebusy WHERE filename=:fn");
+    dPeriods.bindValue(":fn", inFilename);
+    QSqlQuery iPeriod(m_db);
+    iPeriod.prepare("INSERT INTO freebusy VALUES(:fn, :ucid, :start, :end)");
+
+    bool haveTransaction = m_db.transaction();
+    dPeriods.exec();
+    for( const FreeBusyPeriod &period : inPeriods )
+    {
+        iPeriod.bindValue(":fn", inFilename);
+        iPeriod.bindValue(":ucid", period.m_userCalendarId);
+        iPeriod.bindValue(":start", period.m_startSecs);
+        iPeriod.bindValue(":end", period.m_endSecs);
+        if( not iPeriod.exec() )
+            qDebug() << "ERR: Storage::setFreeBusyPeriods(), " << iPeriod.lastError().text();
+    }
+    if( haveTransaction )
+        m_db.commit();
+}
 
+
+void Storage::loadFreeBusyPeriods( const qint64 inStartSecs, const qint64 inEndSecs, QVector<FreeBusyPeriod> &outPeriods )
+{
+    QSqlQuery qPeriods(m_db);
+    qPeriods.prepare("SELECT usercalendar_id, start_secs, end_secs FROM freebusy "
+                     "WHERE end_secs > :start AND start_secs < :end");
+    qPeriods.bindValue(":start", inStartSecs);
+    qPeriods.bindValue(":end", inEndSecs);
+    if( not qPeriods.exec() )
+    {
+        qDebug() << "ERR: Storage::loadFreeBusyPeriods(), " << qPeriods.lastError().text();
+        return;
+    }
+    while( qPeriods.next() )
+        outPeriods.append( FreeBusyPeriod{ qPeriods.value(0).toInt(), qPeriods.value(1).toLongLong(),
+                                           qPeriods.value(2).toLongLong() } );
+}
+
+
+/* Every word of inText is a prefix, all of them have to show up in summary or description.
+ *  Hits come best first. */
+void Storage::searchAppointments( const QString & inText, const int inMaxHits, QVector<SearchHit> &outHits )
+{
+    outHits.clear();
+    if( not m_haveSearch )
+        return;
+
+    QStringList terms;
+    for( QString word : inText.split( ' ', QString::SkipEmptyParts ) )
+        terms.append( QString( "\"%1\"*" ).arg( word.replace( '"', "\"\"" ) ) );
+    if( terms.isEmpty() )
+        return;
+
+    QSqlQuery qSearch( m_db );
+    qSearch.prepare( "SELECT search.uid, basics.summary, basics.start, "
+                     "(SELECT min(events.start) FROM events WHERE events.uid=search.uid AND events.start >= :today) "
+                     "FROM search JOIN basics ON basics.id=search.rowid "
+                     "WHERE search MATCH :terms ORDER BY rank LIMIT :max" );
+    // event start strings begin with yyyyMMdd, so they compare as text
+    qSearch.bindValue( ":today", QDate::currentDate().toString( "yyyyMMdd" ) );
+    qSearch.bindValue( ":terms", terms.join( ' ' ) );
+    qSearch.bindValue( ":max", inMaxHits );
+    if( not qSearch.exec() )
+    {
+        qDebug() << "ERR: Storage::searchAppointments(), " << qSearch.lastError().text();
+        return;
+    }
+    while( qSearch.next() )
+    {
+        SearchHit hit;
+        hit.m_uid = qSearch.value(0).toString();
+        hit.m_summary = qSearch.value(1).toString();
+        // next occurrence from today on, else the start. Streamed appointments have no events.
+        QString start = qSearch.value(3).isNull() ? qSearch.value(2).toString() : qSearch.value(3).toString();
+        hit.m_date = QDate::fromString( start.left( 8 ), "yyyyMMdd" );
+        outHits.append( hit );
+    }
+}
+
+
+void Storage::loadAppointmentByYear(const int year, QVector<Appointment*>& outAppointments )
+{
     QSqlQuery qApmSelect( m_db );
     qApmSelect.prepare( "SELECT uid, min_year, max_year, allyears, "
                         "usercalendar_id, have_recurrence, have_alarms "
                         "FROM appointments WHERE min_year <= :mi and max_year >= :ma" );
     qApmSelect.bindValue( ":mi", year );
     qApmSelect.bindValue( ":ma", year );
+    loadAppointments( qApmSelect, true, outAppointments );
+}
+
+
+void Storage::loadAppointmentsWithAlarms( QVector<Appointment*> &outAppointments )
+{
+    QSqlQuery qApmSelect( m_db );
+    qApmSelect.prepare( "SELECT uid, min_year, max_year, allyears, "
+                        "usercalendar_id, have_recurrence, have_alarms "
+                        "FROM appointments WHERE have_alarms = 1" );
+    loadAppointments( qApmSelect, false, outAppointments );
+}
+
+
+int Storage::loadAppointmentBatch( QString &inoutLastUid, const int inMaxCount, QVector<Appointment*> &outAppointments )
+{
+    QSqlQuery qApmSelect( m_db );
+    qApmSelect.prepare( "SELECT uid, min_year, max_year, allyears, "
+                        "usercalendar_id, have_recurrence, have_alarms "
+                        "FROM appointments WHERE uid > :last ORDER BY uid LIMIT :max" );
+    qApmSelect.bindValue( ":last", inoutLastUid );
+    qApmSelect.bindValue( ":max", inMaxCount );
+    loadAppointments( qApmSelect, false, outAppointments );
+    if( not outAppointments.isEmpty() )
+        inoutLastUid = outAppointments.last()->m_uid;
+    return outAppointments.count();
+}
+
+
+/* qApmSelect is prepared and selects the columns of the appointments table in
+ *  the order of loadAppointmentByYear(). */
+void Storage::loadAppointments( QSqlQuery &qApmSelect, const bool inWithEvents, QVector<Appointment*> &outAppointments )
+{
+    outAppointments.clear();
 
     QSqlQuery qApmBasics( m_db );
     qApmBasics.prepare( "SELECT uid, sequence, start, start_tz, end, end_tz,"
@@ -281,7 +708,7 @@ void Storage::loadAppointmentByYear(const int year, QVector<Appointment*>& outAp
             apmData->m_minYear   = qApmSelect.value(1).toString().toInt( &ok );
             apmData->m_maxYear   = qApmSelect.value(2).toString().toInt( &ok );
             QString yearsString = qApmSelect.value(3).toString();
-            for( const QString s : yearsString.split( ',', QString::SkipEmptyParts) )
+            for( const QString &s : yearsString.split( ',', QString::SkipEmptyParts) )
                 apmData->m_yearsInQuestion.insert( s.toInt(&ok) );
             apmData->m_userCalendarId    = qApmSelect.value(4).toString().toInt(&ok);
             apmData->m_haveRecurrence    = qApmSelect.value(5).toBool();
@@ -369,30 +796,33 @@ void Storage::loadAppointmentByYear(const int year, QVector<Appointment*>& outAp
             }
 
             // read Events
-            qApmEvents.bindValue( ":puid", apmData->m_uid );
-            if( not qApmEvents.exec() )
-            {
-                qDebug() << "ERR qApmEvents.exec()";
-                return;
-            }
-            while (qApmEvents.next())
+            if( inWithEvents )
             {
-                Event e;
-                e.m_uid         = qApmEvents.value(0).toString();
-                e.m_displayText = qApmEvents.value(1).toString();
-                QString tzString    = qApmEvents.value(4).toString();
-                e.m_startDt     = DateTime::string2DateTime( qApmEvents.value(2).toString(), tzString );
-                e.m_endDt       = DateTime::string2DateTime( qApmEvents.value(3).toString(), tzString );
-                e.m_isAlarmEvent    = qApmEvents.value(5).toBool();
-                e.m_userCalendarId = apmData->m_userCalendarId;
-                apmData->m_eventVector.append( e );
+                qApmEvents.bindValue( ":puid", apmData->m_uid );
+                if( not qApmEvents.exec() )
+                {
+                    qDebug() << "ERR qApmEvents.exec()";
+                    return;
+                }
+                while (qApmEvents.next())
+                {
+                    Event e;
+                    e.m_uid         = qApmEvents.value(0).toString();
+                    e.m_displayText = qApmEvents.value(1).toString();
+                    QString tzString    = qApmEvents.value(4).toString();
+                    e.m_startDt     = DateTime::string2DateTime( qApmEvents.value(2).toString(), tzString );
+                    e.m_endDt       = DateTime::string2DateTime( qApmEvents.value(3).toString(), tzString );
+                    e.m_isAlarmEvent    = qApmEvents.value(5).toBool();
+                    e.m_userCalendarId = apmData->m_userCalendarId;
+                    apmData->m_eventVector.append( e );
+                }
             }
 
             outAppointments.append( std::move(apmData) );
         }
     }
     else
-        qDebug() << "Storage::loadAppointmentData() Query Error: " << qApmSelect.lastError().text();
+        qDebug() << "Storage::loadAppointments() Query Error: " << qApmSelect.lastError().text();
 }
 
 
@@ -531,29 +961,65 @@ void Storage::userCalendarDataModified(const int id, const QColor & color, const
 /* delete calendar and associated recurrences and appointments */
 void Storage::removeUserCalendar(const int id)
 {
-    QSqlQuery qApmSelect(m_db);
-    qApmSelect.prepare("SELECT uid, usercalendar_id FROM appointments WHERE usercalendar_id=:id");
+    /* Delete all data belonging to appointments of this calendar set-based,
+     * one statement per table, within one transaction. The appointments table
+     * is the index for all other tables, so it must be cleared last. */
+    const QStringList tables = { "events", "alarms", "recurrences", "basics" };
+    QVector<QSqlQuery> deleteQueries;
+    for( const QString & table : tables )
+    {
+        QSqlQuery q( m_db );
+        q.prepare( QString( "DELETE FROM %1 WHERE uid IN "
+                            "(SELECT uid FROM appointments WHERE usercalendar_id=:id)" ).arg( table ) );
+        q.bindValue( ":id", id );
+        deleteQueries.append( q );
+    }
+
+    QSqlQuery qApmDelete(m_db);
+    qApmDelete.prepare("DELETE FROM appointments WHERE usercalendar_id=:id");
+    qApmDelete.bindValue(":id", id);
+
+    QSqlQuery qFreeBusyDelete(m_db);
+    qFreeBusyDelete.prepare("DELETE FROM freebusy WHERE usercalendar_id=:id");
+    qFreeBusyDelete.bindValue(":id", id);
 
     QSqlQuery qUcalDelete(m_db);
     qUcalDelete.prepare("DELETE FROM usercalendars WHERE id=:id");
+    qUcalDelete.bindValue(":id", id);
 
-    // Delete appointments
-    qApmSelect.bindValue(":id", id);
-    if( qApmSelect.exec() )
+    bool haveTransaction = m_db.transaction();
+    bool ok = true;
+    for( QSqlQuery & q : deleteQueries )
     {
-        while (qApmSelect.next())
+        if( not q.exec() )
         {
-            QString uid = qApmSelect.value(0).toString();
-            removeAppointment( uid );
+            qDebug() << "ERR: Storage::removeUserCalendar(), delete, " << q.lastError().text();
+            ok = false;
         }
     }
-    else
-        qDebug() << "ERR: Storage::removeUserCalendar(), qApmSelect, " << qApmSelect.lastError().text();
+    if( ok and not qApmDelete.exec() )
+    {
+        qDebug() << "ERR: Storage::removeUserCalendar(), qApmDelete, " << qApmDelete.lastError().text();
+        ok = false;
+    }
+    if( ok and not qFreeBusyDelete.exec() )
+    {
+        qDebug() << "ERR: Storage::removeUserCalendar(), qFreeBusyDelete, " << qFreeBusyDelete.lastError().text();
+        ok = false;
+    }
+    if( ok and not qUcalDelete.exec() )
+    {
+        qDebug() << "ERR: Storage::removeUserCalendar(), qUcalDelete, " << qUcalDelete.lastError().text();
+        ok = false;
+    }
 
-    // 3. delete user calendar
-    qUcalDelete.bindValue(":id", id);
-    if(not qUcalDelete.exec() )
-        qDebug() << "ERR: Storage::removeUserCalendar(), qCalDelete, " << qUcalDelete.lastError().text();
+    if( haveTransaction )
+    {
+        if( ok )
+            m_db.commit();
+        else
+            m_db.rollback();
+    }
 }
 
 
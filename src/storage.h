@@ -17,8 +17,13 @@
 #ifndef STORAGE_H
 #define STORAGE_H
 
+#include <QByteArray>
+#include <QDate>
 #include <QObject>
+#include <QPair>
+#include <QSet>
 #include <QSqlDatabase>
+#include <QSqlQuery>
 #include <QVector>
 
 #include "appointmentmanager.h"
@@ -26,6 +31,15 @@
 #include "usercalendar.h"
 
 
+// see Storage::searchAppointments()
+struct SearchHit
+{
+    QString m_uid;
+    QString m_summary;
+    QDate   m_date;     // next occurrence from today on, else the start
+};
+
+
 /* This is the only storage class at the moment. It stores appointments and user calendars in a
  *  SQLITE database.
  */
@@ -35,16 +49,57 @@ class Storage : public QObject
     Q_OBJECT
 
 public:
-    explicit Storage();
-    void createDatabase();
+    /* inConnectionName: empty for the default connection. Threads, which need a storage
+     *  on their own (like ImportStorageThread) give a unique name here.
+     * inDatabaseName: the SQLITE file, tools like importcli use another one. */
+    explicit Storage( const QString & inConnectionName = QString(),
+                      const QString & inDatabaseName = QString( "daylightdb.sqlite3" ) );
+    ~Storage();
+    void createDatabase( const QString & inConnectionName, const QString & inDatabaseName );
+
+    // the SQLITE file, other connections to the same database need this
+    QString databaseName() const;
+
+    // increases with every change of appointments, -1 on error
+    qint64 changeCounter();
+
+    // group many writes into one transaction. Nested transactions are ignored.
+    bool startTransaction();
+    void commitTransaction();
 
     // === appointments ===
     void storeAppointment( const Appointment* apmData );
     // @fixme: this algorithm does not care for userCalendarId:
     void updateAppointment( const Appointment* apmData );
+    /* insert or update by uid. Skips the appointment, if the stored one has the
+     *  same content hash or a higher sequence number. Returns true, if something was written. */
+    bool upsertAppointment( const Appointment* apmData );
     void loadAppointmentByYear( const int year, QVector<Appointment*> &outAppointments);
+    // appointments with alarms, all years, without events
+    void loadAppointmentsWithAlarms( QVector<Appointment*> &outAppointments );
+    /* all appointments in uid order, without events, inMaxCount at a time. Start with an empty
+     *  inoutLastUid, it is moved forward. Returns the number of loaded appointments, 0 at the end. */
+    int loadAppointmentBatch( QString &inoutLastUid, const int inMaxCount, QVector<Appointment*> &outAppointments );
     void removeAppointment(const QString id);   // remove appointment from storage
 
+    // full-text search over summary and description, needs FTS5 in SQLite
+    bool haveSearch() const;
+    void searchAppointments( const QString & inText, const int inMaxHits, QVector<SearchHit> &outHits );
+
+    /* === import hashes ===
+     * remember, what an imported ical file and each of its VEVENTs looked like. Hashes
+     *  of VEVENTs, whose appointment got deleted in the meantime, are not reported. */
+    QByteArray importFileHash( const QString inFilename );
+    QSet<QByteArray> importVEventHashes( const QString inFilename );
+    void setImportHashes( const QString inFilename, const QByteArray inFileHash,
+                          const QVector<QPair<QByteArray, QString>> &inVEventHashes );
+
+    /* === published free/busy ===
+     * busy periods of the VFREEBUSY components of an imported ical file. A new import of
+     *  the file replaces them. load...() returns the periods overlapping inStartSecs ... inEndSecs. */
+    void setFreeBusyPeriods( const QString inFilename, const QVector<FreeBusyPeriod> &inPeriods );
+    void loadFreeBusyPeriods( const qint64 inStartSecs, const qint64 inEndSecs, QVector<FreeBusyPeriod> &outPeriods );
+
     void setAppointmentsCalendar(const QString appointmentId, const int calendarId);
 
     void loadUserCalendarInfo( UserCalendarPool* &ucalPool );
@@ -55,6 +110,11 @@ public:
 
 private:
     QSqlDatabase m_db;
+    bool m_inTransaction;   // true between startTransaction() and commitTransaction()
+    bool m_haveSearch;      // the search table could be created
+    QSqlQuery m_qUpsertSelect;  // prepared once, used for every upsertAppointment()
+
+    void loadAppointments( QSqlQuery &qApmSelect, const bool inWithEvents, QVector<Appointment*> &outAppointments );
 
 signals:
     void sigStoreEvent(int first, int current, int count );
@@ -117,6 +117,36 @@ bool UserCalendarPool::isVisible(const int id) const
 }
 
 
+QBitArray UserCalendarPool::hiddenCalendars() const
+{
+    QBitArray hidden;
+    for(const UserCalendarInfo* uci : m_pool)
+    {
+        if(uci->m_isVisible or uci->m_id < 0)
+            continue;
+        if(uci->m_id >= hidden.size())
+            hidden.resize(uci->m_id + 1);
+        hidden.setBit(uci->m_id);
+    }
+    return hidden;
+}
+
+
+QBitArray UserCalendarPool::visibleCalendars() const
+{
+    QBitArray visible;
+    for(const UserCalendarInfo* uci : m_pool)
+    {
+        if(not uci->m_isVisible or uci->m_id < 0)
+            continue;
+        if(uci->m_id >= visible.size())
+            visible.resize(uci->m_id + 1);
+        visible.setBit(uci->m_id);
+    }
+    return visible;
+}
+
+
 const UserCalendarInfo* UserCalendarPool::item(const int id) const
 {
     for(UserCalendarInfo* uci : m_pool)
@@ -17,6 +17,7 @@
 #ifndef USERCALENDAR_H
 #define USERCALENDAR_H
 
+#include <QBitArray>
 #include <QColor>
 #include <QMenu>
 
@@ -56,6 +57,8 @@ public:
     QColor color(const int id) const;
     QString title(const int id) const;
     bool isVisible(const int id) const;
+    QBitArray hiddenCalendars() const;     // bit set for every calendar id, which is switched off
+    QBitArray visibleCalendars() const;    // bit set for every calendar id, which is switched on
     const UserCalendarInfo* item(const int id) const;
     void setData(const int id, const QColor & color, const QString & title, const bool visible);
 